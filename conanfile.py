@@ -67,6 +67,7 @@ class TeiaCareVideoIO(ConanFile):
         self.options["ffmpeg"].disable_all_parsers=True
         self.options["ffmpeg"].disable_all_hardware_accelerators=True
         self.options["ffmpeg"].disable_all_bitstream_filters=True
+        self.options["ffmpeg"].enable_bitstream_filters='h264_mp4toannexb,hevc_mp4toannexb'
         self.options["ffmpeg"].disable_all_devices=True
         self.options["ffmpeg"].disable_all_filters=True
 
@@ -0,0 +1,167 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/concurrent_queue.hpp>
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tc::vio::benchmarks
+{
+// Only frame handles go through the queues: the producer cycles over a few 1080p RGB buffers
+struct frame_handle
+{
+    const uint8_t* data = nullptr; // nullptr: end of stream
+    int64_t pushed_ns = 0;
+};
+
+static constexpr size_t frame_buffer_count = 8;
+static constexpr size_t frame_buffer_size = 1920 * 1080 * 3;
+static constexpr size_t queue_capacity = 4;
+
+static int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Baseline: same put/get as the mutex and condition variables frame_queue of the examples
+struct mutex_queue
+{
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<frame_handle> q;
+
+    void push(frame_handle h)
+    {
+        std::unique_lock lock(mutex);
+        not_full.wait(lock, [this] { return q.size() < queue_capacity; });
+        const bool was_empty = q.empty();
+        q.push_back(h);
+        lock.unlock();
+        if (was_empty)
+            not_empty.notify_one();
+    }
+
+    void pop(frame_handle& h)
+    {
+        std::unique_lock lock(mutex);
+        not_empty.wait(lock, [this] { return !q.empty(); });
+        h = q.front();
+        q.pop_front();
+        const bool was_full = q.size() == queue_capacity - 1;
+        lock.unlock();
+        if (was_full)
+            not_full.notify_one();
+    }
+};
+
+template <typename Queue>
+struct lock_free_queue
+{
+    Queue q{queue_capacity};
+    void push(frame_handle h) { q.push(h); }
+    void pop(frame_handle& h) { q.pop(h); }
+};
+
+using spsc_frame_queue = lock_free_queue<vio::spsc_queue<frame_handle>>;
+using mpmc_frame_queue = lock_free_queue<vio::mpmc_queue<frame_handle>>;
+
+// Move frame handles from a producer thread to a consumer thread as fast as possible
+template <typename Queue>
+static void queue_throughput(benchmark::State& state)
+{
+    const std::vector<uint8_t> frames(frame_buffer_count * frame_buffer_size);
+    const int64_t frame_count = state.range(0);
+
+    for (auto _ : state)
+    {
+        Queue queue;
+        std::thread producer(
+            [&]
+            {
+                for (int64_t i = 0; i < frame_count; ++i)
+                    queue.push({frames.data() + (i % frame_buffer_count) * frame_buffer_size, 0});
+                queue.push({});
+            });
+
+        frame_handle h;
+        for (queue.pop(h); h.data; queue.pop(h))
+            benchmark::DoNotOptimize(h.data);
+
+        producer.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * frame_count);
+}
+
+// Produce frames at 1080p60 pace and measure the time from push to pop, including the consumer wake-up
+template <typename Queue>
+static void queue_latency_60fps(benchmark::State& state)
+{
+    const std::vector<uint8_t> frames(frame_buffer_count * frame_buffer_size);
+    const int64_t frame_count = state.range(0);
+    const auto frame_interval = std::chrono::microseconds(1000000 / 60);
+
+    std::vector<int64_t> latencies_ns;
+    for (auto _ : state)
+    {
+        Queue queue;
+        std::thread producer(
+            [&]
+            {
+                auto next_frame_time = std::chrono::steady_clock::now();
+                for (int64_t i = 0; i < frame_count; ++i)
+                {
+                    std::this_thread::sleep_until(next_frame_time);
+                    next_frame_time += frame_interval;
+                    queue.push({frames.data() + (i % frame_buffer_count) * frame_buffer_size, now_ns()});
+                }
+                queue.push({});
+            });
+
+        frame_handle h;
+        for (queue.pop(h); h.data; queue.pop(h))
+            latencies_ns.push_back(now_ns() - h.pushed_ns);
+
+        producer.join();
+    }
+
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    if (latencies_ns.empty())
+        return;
+
+    state.counters["latency_p50_us"] = static_cast<double>(latencies_ns[latencies_ns.size() / 2]) / 1000.0;
+    state.counters["latency_p99_us"] = static_cast<double>(latencies_ns[latencies_ns.size() * 99 / 100]) / 1000.0;
+    state.counters["latency_max_us"] = static_cast<double>(latencies_ns.back()) / 1000.0;
+}
+
+// frames: 100000
+BENCHMARK_TEMPLATE(queue_throughput, mutex_queue)->Arg(100000)->ArgName("frames")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(queue_throughput, spsc_frame_queue)->Arg(100000)->ArgName("frames")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(queue_throughput, mpmc_frame_queue)->Arg(100000)->ArgName("frames")->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// frames: 120 (2 seconds at 60 fps)
+BENCHMARK_TEMPLATE(queue_latency_60fps, mutex_queue)->Arg(120)->ArgName("frames")->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(queue_latency_60fps, spsc_frame_queue)->Arg(120)->ArgName("frames")->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_TEMPLATE(queue_latency_60fps, mpmc_frame_queue)->Arg(120)->ArgName("frames")->Iterations(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
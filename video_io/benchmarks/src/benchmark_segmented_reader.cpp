@@ -0,0 +1,57 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/segmented_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+namespace tc::vio::benchmarks
+{
+// Decode the whole file with the given number of workers, in order (1) or as frames become available (0).
+// Compare the fps counter across worker counts to measure the scaling.
+static void segmented_reader_workers(benchmark::State& state)
+{
+    const auto video_path = std::filesystem::path(utils::video_data_path) / "video_120sec_30fps_SD.mp4";
+    const auto segmented_opt = vio::segmented_options{.worker_count = static_cast<int>(state.range(0)), .ordered = state.range(1) != 0};
+
+    int64_t read_frames = 0;
+    for (auto _ : state)
+    {
+        vio::segmented_reader r;
+        if (!r.open(video_path.string().c_str(), vio::decode_support::SW, {}, segmented_opt))
+        {
+            state.SkipWithError("Unable to open input video");
+            return;
+        }
+
+        vio::frame f;
+        while (r.read(f))
+        {
+            ++read_frames;
+        }
+    }
+
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(read_frames), benchmark::Counter::kIsRate);
+}
+
+// workers: 1, 2, 4, 8 - ordered: 0, 1
+BENCHMARK(segmented_reader_workers)
+    ->ArgsProduct({{1, 2, 4, 8}, {0, 1}})
+    ->ArgNames({"workers", "ordered"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}
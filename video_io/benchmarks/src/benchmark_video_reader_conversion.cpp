@@ -0,0 +1,62 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+namespace tc::vio::benchmarks
+{
+static const std::array<vio::pixel_format, 3> conversion_formats = {
+    vio::pixel_format::rgb24,
+    vio::pixel_format::bgr24,
+    vio::pixel_format::rgba};
+
+// Decode a FHD file to RGB with the SIMD kernels (1) or swscale (0), on one or more conversion threads: the difference is the conversion cost
+static void video_reader_conversion(benchmark::State& state)
+{
+    const auto video_path = std::filesystem::path(utils::video_data_path) / "video_10sec_4fps_FHD.mp4";
+    const auto output_opt = vio::output_options{.format = conversion_formats.at(state.range(0)), .simd_conversion = state.range(1) != 0, .conversion_threads = static_cast<int>(state.range(2))};
+
+    int64_t decoded_frames = 0;
+    for (auto _ : state)
+    {
+        vio::video_reader v;
+        if (!v.open(video_path.string().c_str(), vio::decode_support::SW, {}, output_opt))
+        {
+            state.SkipWithError("Unable to open input video");
+            return;
+        }
+
+        vio::frame f;
+        while (v.read(f))
+        {
+            ++decoded_frames;
+        }
+    }
+
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(decoded_frames), benchmark::Counter::kIsRate);
+}
+
+// format: rgb24, bgr24, rgba - simd: 0, 1 - threads: 1, 4
+BENCHMARK(video_reader_conversion)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}, {1, 4}})
+    ->ArgNames({"format", "simd", "threads"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}
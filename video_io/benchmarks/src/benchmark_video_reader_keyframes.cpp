@@ -0,0 +1,79 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <filesystem>
+
+namespace tc::vio::benchmarks
+{
+static const std::array<const char*, 2> keyframes_video_names = {
+    "video_120sec_30fps_SD.mp4",
+    "video_10sec_30fps_HD.mp4"};
+
+static int64_t read_all_frames(const std::filesystem::path& video_path, const vio::decode_options& decode_opt)
+{
+    vio::video_reader v;
+    if (!v.open(video_path.string().c_str(), vio::decode_support::SW, decode_opt))
+        return -1;
+
+    int64_t frames = 0;
+    uint8_t* data = nullptr;
+    while (v.read(&data))
+    {
+        ++frames;
+    }
+    return frames;
+}
+
+// Read the whole file with keyframes_only disabled (0) or enabled (1).
+// The speedup counter is relative to a full decode of the same file, timed once before the benchmark loop.
+static void video_reader_keyframes_only(benchmark::State& state)
+{
+    const auto video_path = std::filesystem::path(utils::video_data_path) / keyframes_video_names.at(state.range(0));
+    const auto decode_opt = vio::decode_options{.keyframes_only = state.range(1) != 0};
+
+    const auto full_decode_start = std::chrono::steady_clock::now();
+    if (read_all_frames(video_path, {}) < 0)
+    {
+        state.SkipWithError("Unable to open input video");
+        return;
+    }
+    const std::chrono::duration<double> full_decode_time = std::chrono::steady_clock::now() - full_decode_start;
+
+    int64_t read_frames = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (auto _ : state)
+    {
+        read_frames += read_all_frames(video_path, decode_opt);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(read_frames), benchmark::Counter::kIsRate);
+    state.counters["frames"] = benchmark::Counter(static_cast<double>(read_frames), benchmark::Counter::kAvgIterations);
+    state.counters["speedup"] = full_decode_time.count() * static_cast<double>(state.iterations()) / elapsed.count();
+}
+
+// video: 120sec SD, 10sec HD - keyframes_only: 0, 1
+BENCHMARK(video_reader_keyframes_only)
+    ->ArgsProduct({{0, 1}, {0, 1}})
+    ->ArgNames({"video", "keyframes_only"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}
@@ -0,0 +1,131 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/video_reader.hpp>
+#include <teiacare/video_io/video_writer.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tc::vio::benchmarks
+{
+// Glass-to-frame latency of a live RTSP input. A local stand-in camera pushes a file in real time (RTSP muxer, RECORD)
+// to the reader, which listens as the RTSP server: latency is the time from pushing the n-th packet to reading the n-th frame.
+static void video_reader_live_latency(benchmark::State& state)
+{
+    using clock = std::chrono::steady_clock;
+
+    const auto video_path = std::filesystem::path(utils::video_data_path) / "video_10sec_30fps_HD.mp4";
+    const std::string url = "rtsp://127.0.0.1:8554/live";
+    auto input_opt = state.range(0) != 0 ? vio::input_options::low_latency() : vio::input_options{};
+    input_opt.rtsp_listen = true;
+
+    std::chrono::duration<double, std::milli> total_latency{0};
+    std::chrono::duration<double, std::milli> max_latency{0};
+    std::chrono::duration<double, std::milli> total_first_frame{0};
+    int64_t frame_count = 0;
+    int64_t iterations = 0;
+
+    for (auto _ : state)
+    {
+        std::mutex mutex;
+        std::vector<clock::time_point> sent;
+
+        std::thread camera([&] {
+            vio::video_reader source;
+            if (!source.open(video_path.string().c_str()))
+                return;
+
+            const auto parameters = source.get_codec_parameters();
+            if (!parameters)
+                return;
+
+            // The reader only accepts connections once it is listening
+            vio::video_writer writer;
+            for (int attempt = 0; attempt < 200 && !writer.open(url, *parameters); ++attempt)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+            if (!writer.is_opened())
+                return;
+
+            const auto start = clock::now();
+            vio::packet p;
+            while (source.read_packet(p))
+            {
+                std::this_thread::sleep_until(start + std::chrono::duration<double>(std::max(0.0, p.dts())));
+                {
+                    std::lock_guard lock(mutex);
+                    sent.push_back(clock::now());
+                }
+
+                if (!writer.write_packet(p))
+                    break;
+            }
+
+            writer.save();
+        });
+
+        const auto open_start = clock::now();
+        vio::video_reader v;
+        if (!v.open(url.c_str(), vio::decode_support::SW, {}, {}, input_opt))
+        {
+            camera.join();
+            state.SkipWithError("Unable to open the RTSP stand-in");
+            return;
+        }
+
+        vio::frame f;
+        int64_t n = 0;
+        while (v.read(f))
+        {
+            const auto now = clock::now();
+            if (n == 0)
+                total_first_frame += now - open_start;
+
+            std::lock_guard lock(mutex);
+            if (static_cast<size_t>(n) < sent.size())
+            {
+                const auto latency = std::chrono::duration<double, std::milli>(now - sent[n]);
+                total_latency += latency;
+                max_latency = std::max(max_latency, latency);
+                ++frame_count;
+            }
+            ++n;
+        }
+
+        camera.join();
+        ++iterations;
+    }
+
+    state.counters["latency_ms"] = frame_count > 0 ? total_latency.count() / static_cast<double>(frame_count) : 0.0;
+    state.counters["max_latency_ms"] = max_latency.count();
+    state.counters["first_frame_ms"] = iterations > 0 ? total_first_frame.count() / static_cast<double>(iterations) : 0.0;
+}
+
+// profile: 0 default input options, 1 input_options::low_latency()
+BENCHMARK(video_reader_live_latency)
+    ->DenseRange(0, 1)
+    ->ArgName("low_latency")
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}
@@ -0,0 +1,109 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/stream_hint.hpp>
+#include <teiacare/video_io/video_info.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace tc::vio::benchmarks
+{
+// Generated by scripts/tests/generate_test_data.py
+static const std::array<const char*, 8> video_names = {
+    "video_10sec_4fps_SD.mp4",
+    "video_10sec_4fps_HD.mp4",
+    "video_10sec_4fps_FHD.mp4",
+    "video_10sec_4fps_4K.mp4",
+    "video_10sec_4fps_SD.mkv",
+    "video_10sec_4fps_HD.mkv",
+    "video_10sec_4fps_FHD.mkv",
+    "video_10sec_4fps_4K.mkv"};
+
+static std::shared_ptr<vio::stream_hint_cache> make_hint_cache(bool is_enabled)
+{
+    if (!is_enabled)
+        return nullptr;
+
+    // Hints of a previous scan of the same files
+    auto cache = std::make_shared<vio::stream_hint_cache>();
+    vio::video_info info;
+    for (const auto* video_name : video_names)
+        info.get_video_metadata((std::filesystem::path(utils::video_data_path) / video_name).string(), cache);
+
+    return cache;
+}
+
+// Open every file (up to the first decoded frame) with full probing (0) or with the stream hints of a previous scan (1)
+static void video_reader_open(benchmark::State& state)
+{
+    const auto hint_cache = make_hint_cache(state.range(0) != 0);
+
+    int64_t opened_files = 0;
+    for (auto _ : state)
+    {
+        for (const auto* video_name : video_names)
+        {
+            const auto video_path = std::filesystem::path(utils::video_data_path) / video_name;
+
+            vio::video_reader v;
+            if (!v.open(video_path.string().c_str(), vio::decode_support::SW, {}, {.format = vio::pixel_format::native}, {.hint_cache = hint_cache}))
+            {
+                state.SkipWithError("Unable to open input video");
+                return;
+            }
+
+            vio::frame f;
+            benchmark::DoNotOptimize(v.read(f));
+            ++opened_files;
+        }
+    }
+
+    state.counters["files_per_second"] = benchmark::Counter(static_cast<double>(opened_files), benchmark::Counter::kIsRate);
+}
+
+// Metadata of every file with full probing (0) or with the stream hints of a previous scan (1)
+static void video_info_open(benchmark::State& state)
+{
+    const auto hint_cache = make_hint_cache(state.range(0) != 0);
+
+    int64_t opened_files = 0;
+    for (auto _ : state)
+    {
+        vio::video_info info;
+        for (const auto* video_name : video_names)
+        {
+            const auto video_path = std::filesystem::path(utils::video_data_path) / video_name;
+            if (!info.get_video_metadata(video_path.string(), hint_cache))
+            {
+                state.SkipWithError("Unable to open input video");
+                return;
+            }
+            ++opened_files;
+        }
+    }
+
+    state.counters["files_per_second"] = benchmark::Counter(static_cast<double>(opened_files), benchmark::Counter::kIsRate);
+}
+
+// hint: 0 full probing, 1 stream hint cache
+BENCHMARK(video_reader_open)->DenseRange(0, 1)->ArgName("hint")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(video_info_open)->DenseRange(0, 1)->ArgName("hint")->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
@@ -0,0 +1,109 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <filesystem>
+#include <new>
+
+namespace tc::vio::benchmarks
+{
+static const std::array<const char*, 2> read_into_video_names = {
+    "video_10sec_4fps_FHD.mp4",
+    "video_10sec_4fps_4K.mp4"};
+
+struct aligned_buffer
+{
+    explicit aligned_buffer(size_t size)
+        : data{new (std::align_val_t{vio::video_reader::buffer_alignment}) uint8_t[size]}
+    {
+    }
+
+    ~aligned_buffer()
+    {
+        ::operator delete[](data, std::align_val_t{vio::video_reader::buffer_alignment});
+    }
+
+    uint8_t* data;
+};
+
+// Baseline: decode into the reader's internal frame, then copy it into the caller's buffer
+static void video_reader_read_and_copy(benchmark::State& state)
+{
+    const auto video_path = std::filesystem::path(utils::video_data_path) / read_into_video_names.at(state.range(0));
+
+    int64_t decoded_frames = 0;
+    for (auto _ : state)
+    {
+        vio::video_reader v;
+        if (!v.open(video_path.string().c_str()))
+        {
+            state.SkipWithError("Unable to open input video");
+            return;
+        }
+
+        const size_t frame_size = static_cast<size_t>(v.get_frame_size_in_bytes().value());
+        aligned_buffer buffer(frame_size);
+
+        uint8_t* data = nullptr;
+        while (v.read(&data))
+        {
+            std::memcpy(buffer.data, data, frame_size);
+            benchmark::ClobberMemory();
+            ++decoded_frames;
+        }
+    }
+
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(decoded_frames), benchmark::Counter::kIsRate);
+}
+
+// Convert straight into the caller's buffer: no intermediate frame and no memcpy
+static void video_reader_read_into(benchmark::State& state)
+{
+    const auto video_path = std::filesystem::path(utils::video_data_path) / read_into_video_names.at(state.range(0));
+
+    int64_t decoded_frames = 0;
+    for (auto _ : state)
+    {
+        vio::video_reader v;
+        if (!v.open(video_path.string().c_str()))
+        {
+            state.SkipWithError("Unable to open input video");
+            return;
+        }
+
+        const auto [width, height] = v.get_frame_size().value();
+        const int stride = width * 3;
+        const size_t frame_size = static_cast<size_t>(stride) * height;
+        aligned_buffer buffer(frame_size);
+
+        while (v.read_into(buffer.data, stride, frame_size))
+        {
+            benchmark::ClobberMemory();
+            ++decoded_frames;
+        }
+    }
+
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(decoded_frames), benchmark::Counter::kIsRate);
+}
+
+// resolution: FHD, 4K
+BENCHMARK(video_reader_read_and_copy)->DenseRange(0, 1)->ArgName("resolution")->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(video_reader_read_into)->DenseRange(0, 1)->ArgName("resolution")->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
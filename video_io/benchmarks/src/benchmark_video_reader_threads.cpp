@@ -0,0 +1,67 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <array>
+#include <benchmark/benchmark.h>
+#include <filesystem>
+
+namespace tc::vio::benchmarks
+{
+// Generated by scripts/tests/generate_test_data.py
+static const std::array<const char*, 4> video_names = {
+    "video_10sec_4fps_SD.mp4",
+    "video_10sec_4fps_HD.mp4",
+    "video_10sec_4fps_FHD.mp4",
+    "video_10sec_4fps_4K.mp4"};
+
+static void video_reader_decode_threads(benchmark::State& state)
+{
+    const auto video_path = std::filesystem::path(utils::video_data_path) / video_names.at(state.range(0));
+    const auto decode_opt = vio::decode_options{.thread_count = static_cast<int>(state.range(1))};
+
+    int64_t decoded_frames = 0;
+    int decode_threads = 0;
+    for (auto _ : state)
+    {
+        vio::video_reader v;
+        if (!v.open(video_path.string().c_str(), vio::decode_support::SW, decode_opt))
+        {
+            state.SkipWithError("Unable to open input video");
+            return;
+        }
+
+        decode_threads = v.get_decode_thread_count().value_or(0);
+
+        uint8_t* data = nullptr;
+        while (v.read(&data))
+        {
+            ++decoded_frames;
+        }
+    }
+
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(decoded_frames), benchmark::Counter::kIsRate);
+    state.counters["decode_threads"] = decode_threads;
+}
+
+// resolution: SD, HD, FHD, 4K - threads: 0 selects the default thread count
+BENCHMARK(video_reader_decode_threads)
+    ->ArgsProduct({{0, 1, 2, 3}, {1, 2, 4, 8, 16, 0}})
+    ->ArgNames({"resolution", "threads"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}
@@ -159,7 +159,7 @@ bool try_put_until(value_type* val, const std::chrono::time_point<Clock,Duration
         if (_queue.empty())
             notEmptyCond_.wait(g, [=, this] { return !_queue.empty(); });
         auto val = std::move(_queue.front());
-        _queue.pop();
+        _queue.pop_front();
         if (_queue.size() == _max_size - 1)
         {
             g.unlock();
@@ -17,14 +17,12 @@
  * author:		Stefano Lusardi
  * date:		Jun 2021
  * description:	Example to show how to integrate vio::video_reader in a simple video player based on OpenGL (using GLFW).
- * 				Multi threaded: one (background) thread decodes and enqueue frames, the other (main) dequeues and renders them in order.
+ * 				Multi threaded: vio::async_reader decodes frames on a background thread, the main thread dequeues and renders them in order.
  * 				For simpler examples(single thread) you might want to have a look at any video_player_xxx example (no multi_thread).
  */
 
-#include <teiacare/video_io/video_reader.hpp>
+#include <teiacare/video_io/async_reader.hpp>
 
-#include "utils/frame_queue.hpp"
-#include "utils/simple_frame.hpp"
 #include "utils/video_data_path.hpp"
 #include <GLFW/glfw3.h>
 #include <filesystem>
@@ -33,26 +31,6 @@
 
 using namespace std::chrono_literals;
 
-void decode_thread(tc::vio::video_reader& v, tc::vio::examples::utils::frame_queue<tc::vio::examples::utils::simple_frame>& frame_queue, bool& is_decoding_required)
-{
-    int frames_decoded = 0;
-    while (is_decoding_required)
-    {
-        tc::vio::examples::utils::simple_frame frame;
-        if (!v.read(&frame.data, &frame.pts))
-        {
-            std::cout << "Video finished" << std::endl;
-            std::cout << "frames decoded: " << frames_decoded << std::endl;
-            break;
-        }
-
-        frame_queue.put(std::move(frame));
-        ++frames_decoded;
-    }
-
-    is_decoding_required = false;
-}
-
 bool setup_opengl(GLFWwindow** window, GLuint& texture_handle, int frame_width, int frame_height)
 {
     if (!glfwInit())
@@ -91,7 +69,7 @@ bool setup_opengl(GLFWwindow** window, GLuint& texture_handle, int frame_width,
     return true;
 }
 
-void draw_frame(GLFWwindow* window, GLuint& texture_handle, int frame_width, int frame_height, uint8_t* frame_data)
+void draw_frame(GLFWwindow* window, GLuint& texture_handle, int frame_width, int frame_height, const uint8_t* frame_data)
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, frame_width, frame_height, 0, GL_RGB, GL_UNSIGNED_BYTE, frame_data);
@@ -129,14 +107,15 @@ double get_elapsed_time()
 int main(int argc, char** argv)
 {
     std::cout << "GLFW version: " << glfwGetVersionString() << std::endl;
-    tc::vio::video_reader v;
+    tc::vio::async_reader v;
 
     std::filesystem::path default_video_path = std::filesystem::path(tc::vio::examples::utils::video_data_path) / "video_10sec_2fps_HD.mp4";
     auto video_path = default_video_path.string();
     if (argc > 1)
         video_path = argv[1];
 
-    if (!v.open(video_path.c_str()))
+    // Decode up to 3 frames ahead of the rendering thread
+    if (!v.open(video_path.c_str(), tc::vio::decode_support::none, {}, {}, {.capacity = 3}))
     {
         std::cout << "Unable to open video: " << video_path << std::endl;
         return 1;
@@ -145,10 +124,6 @@ int main(int argc, char** argv)
     const auto frame_size = v.get_frame_size();
     const auto [frame_width, frame_height] = frame_size.value();
 
-    bool is_decoding_required = true;
-    tc::vio::examples::utils::frame_queue<tc::vio::examples::utils::simple_frame> frame_queue(3);
-    std::thread t(&decode_thread, std::ref(v), std::ref(frame_queue), std::ref(is_decoding_required));
-
     GLFWwindow* window = nullptr;
     GLuint texture_handle;
 
@@ -156,7 +131,7 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
 
     int frames_shown = 0;
-    tc::vio::examples::utils::simple_frame frame;
+    tc::vio::frame frame;
 
     std::chrono::time_point<std::chrono::steady_clock, std::chrono::duration<double>> start_time = std::chrono::steady_clock::now();
     std::chrono::duration<double> elapsed_time(0.0);
@@ -166,13 +141,19 @@ int main(int argc, char** argv)
 
     while (!glfwWindowShouldClose(window))
     {
-        if (!frame_queue.try_get(&frame) && !is_decoding_required)
-            break;
+        if (!v.read_for(frame, 100ms))
+        {
+            if (v.is_end_of_stream())
+                break;
+
+            glfwPollEvents();
+            continue;
+        }
 
-        if (const auto timeout = frame.pts - get_elapsed_time(); timeout > 0.0)
+        if (const auto timeout = frame.pts() - get_elapsed_time(); timeout > 0.0)
             std::this_thread::sleep_for(std::chrono::duration<double>(timeout));
 
-        draw_frame(window, texture_handle, frame_width, frame_height, frame.data);
+        draw_frame(window, texture_handle, frame_width, frame_height, frame.data());
         ++frames_shown;
     }
 
@@ -180,8 +161,6 @@ int main(int argc, char** argv)
     std::cout << "Decode time: " << std::chrono::duration_cast<std::chrono::milliseconds>(total_end_time - total_start_time).count() << "ms" << std::endl;
     std::cout << "Frames shown:   " << frames_shown << std::endl;
 
-    is_decoding_required = false;
-    t.join();
     v.release();
 
     glfwDestroyWindow(window);
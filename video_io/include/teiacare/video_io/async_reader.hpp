@@ -0,0 +1,93 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/frame.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace tc::vio
+{
+enum class overflow_policy
+{
+    block,       // the decoding thread waits for a free slot
+    drop_oldest, // the oldest queued frame is replaced by the new one
+    drop_newest  // the new frame is discarded
+};
+
+struct async_options
+{
+    size_t capacity = 4;
+    overflow_policy overflow = overflow_policy::block;
+};
+
+// Decodes ahead on a background thread into a ring of frames.
+// Frames are exchanged with the caller's handle: the buffer the caller passes in goes back to the ring and is
+// reused by the decoder (unless the caller still shares it), so steady state reading does not allocate.
+class async_reader
+{
+public:
+    explicit async_reader() noexcept;
+    ~async_reader() noexcept;
+
+    async_reader(const async_reader&) = delete;
+    async_reader& operator=(const async_reader&) = delete;
+
+    bool open(const char* video_path, decode_support decode_preference = decode_support::none, const decode_options& decode_opt = {}, const output_options& output_opt = {}, const async_options& async_opt = {}, const input_options& input_opt = {});
+    bool is_opened() const;
+    bool read(frame& f);
+    bool try_read(frame& f);
+    bool read_for(frame& f, std::chrono::steady_clock::duration timeout);
+    void release();
+
+    // True once the decoding thread has stopped and every queued frame has been read
+    bool is_end_of_stream() const;
+
+    auto get_frame_size() const -> std::optional<std::tuple<int, int>>;
+    auto get_fps() const -> std::optional<double>;
+    auto get_queue_size() const -> size_t;
+    auto get_queue_capacity() const -> size_t;
+    auto get_dropped_frame_count() const -> uint64_t;
+
+private:
+    void decode_loop();
+    void pop(frame& f);
+
+    std::unique_ptr<video_reader> _reader;
+    async_options _options;
+
+    std::vector<frame> _ring;
+    size_t _head;
+    size_t _size;
+    uint64_t _dropped_frames;
+    bool _is_decoding;
+    bool _stop;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+    std::thread _thread;
+};
+
+}
@@ -0,0 +1,360 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace tc::vio
+{
+// Fixed instead of std::hardware_destructive_interference_size, whose value may differ between translation units
+inline constexpr size_t cache_line_size = 64;
+
+namespace detail
+{
+// Lets threads sleep until a lock-free queue changes, without any cost for the other side while nobody waits.
+// The queue positions are published and observed with sequentially consistent operations, like the waiter count:
+// either a waiter sees the new position when it checks again, or the publisher sees the waiter and wakes it up.
+class queue_signal
+{
+public:
+    // Return once ready() returns true: ready() is evaluated again after every notification
+    template <typename Predicate>
+    void wait(Predicate ready)
+    {
+        while (!ready())
+        {
+            _waiters.fetch_add(1);
+            const uint32_t events = _events.load();
+
+            // Checked again after registering as a waiter: any later change is notified
+            const bool is_ready = ready();
+            if (!is_ready)
+                _events.wait(events);
+
+            _waiters.fetch_sub(1);
+            if (is_ready)
+                return;
+        }
+    }
+
+    void notify()
+    {
+        if (_waiters.load() > 0)
+            notify_all();
+    }
+
+    void notify_all()
+    {
+        _events.fetch_add(1);
+        _events.notify_all();
+    }
+
+private:
+    std::atomic<uint32_t> _waiters{0};
+    std::atomic<uint32_t> _events{0};
+};
+}
+
+// Bounded lock-free ring for one producer thread and one consumer thread.
+// try_push() and try_pop() never block. push() and pop() sleep while the queue is full or empty, until close().
+// T must be default constructible and move assignable: slots are reused, values are moved in and out of them.
+template <typename T>
+class spsc_queue
+{
+public:
+    // The capacity is rounded up to a power of two
+    explicit spsc_queue(size_t capacity)
+        : _slots(std::bit_ceil(std::max<size_t>(1, capacity)))
+        , _mask{_slots.size() - 1}
+    {
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    template <typename U>
+    bool try_push(U&& item)
+    {
+        if (_closed.load(std::memory_order_relaxed))
+            return false;
+
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _producer_head == _slots.size())
+        {
+            // Only refresh the consumer position when the cached one says the queue is full
+            _producer_head = _head.load();
+            if (tail - _producer_head == _slots.size())
+                return false;
+        }
+
+        _slots[tail & _mask] = std::forward<U>(item);
+        _tail.store(tail + 1);
+        _not_empty.notify();
+        return true;
+    }
+
+    bool try_pop(T& item)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _consumer_tail)
+        {
+            _consumer_tail = _tail.load();
+            if (head == _consumer_tail)
+                return false;
+        }
+
+        item = std::move(_slots[head & _mask]);
+        _head.store(head + 1);
+        _not_full.notify();
+        return true;
+    }
+
+    // Wait for a free slot. Return false if the queue is closed.
+    template <typename U>
+    bool push(U&& item)
+    {
+        bool is_pushed = false;
+        _not_full.wait([&] { return (is_pushed = try_push(std::forward<U>(item))) || is_closed(); });
+        return is_pushed;
+    }
+
+    // Wait for an item. Return false once the queue is closed and empty.
+    bool pop(T& item)
+    {
+        bool is_popped = false;
+        _not_empty.wait([&] { return (is_popped = try_pop(item)) || is_closed(); });
+        return is_popped;
+    }
+
+    // Wake up every waiting thread: push() fails from now on, pop() once the queue is empty
+    void close()
+    {
+        _closed.store(true);
+        _not_empty.notify_all();
+        _not_full.notify_all();
+    }
+
+    bool is_closed() const
+    {
+        return _closed.load();
+    }
+
+    // Drop the queued items and accept new ones again: only while neither the producer nor the consumer is running
+    void reset()
+    {
+        for (auto& slot : _slots)
+            slot = T{};
+
+        _head.store(0);
+        _tail.store(0);
+        _consumer_tail = 0;
+        _producer_head = 0;
+        _closed.store(false);
+    }
+
+    // Exact only when called by the producer or the consumer while the other one is idle
+    size_t size() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const
+    {
+        return _slots.size();
+    }
+
+private:
+    // Consumer side
+    alignas(cache_line_size) std::atomic<size_t> _head{0};
+    size_t _consumer_tail = 0;
+
+    // Producer side
+    alignas(cache_line_size) std::atomic<size_t> _tail{0};
+    size_t _producer_head = 0;
+
+    alignas(cache_line_size) std::vector<T> _slots;
+    const size_t _mask;
+    std::atomic<bool> _closed{false};
+    detail::queue_signal _not_empty;
+    detail::queue_signal _not_full;
+};
+
+// Bounded lock-free queue for any number of producer and consumer threads (D. Vyukov's bounded MPMC queue).
+// Every slot has a sequence number that tells whether it is free for the producer or ready for the consumer
+// of a given position, so that producers and consumers only contend on their own position counter.
+template <typename T>
+class mpmc_queue
+{
+public:
+    // The capacity is rounded up to a power of two
+    explicit mpmc_queue(size_t capacity)
+        : _capacity{std::bit_ceil(std::max<size_t>(1, capacity))}
+        , _mask{_capacity - 1}
+        , _cells{std::make_unique<cell[]>(_capacity)}
+    {
+        for (size_t i = 0; i < _capacity; ++i)
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    template <typename U>
+    bool try_push(U&& item)
+    {
+        if (_closed.load(std::memory_order_relaxed))
+            return false;
+
+        size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        cell* c = nullptr;
+        while (true)
+        {
+            c = &_cells[pos & _mask];
+            const size_t sequence = c->sequence.load();
+            const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        c->data = std::forward<U>(item);
+        c->sequence.store(pos + 1);
+        _not_empty.notify();
+        return true;
+    }
+
+    bool try_pop(T& item)
+    {
+        size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        cell* c = nullptr;
+        while (true)
+        {
+            c = &_cells[pos & _mask];
+            const size_t sequence = c->sequence.load();
+            const auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false; // empty
+            }
+            else
+            {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(c->data);
+        c->sequence.store(pos + _capacity);
+        _not_full.notify();
+        return true;
+    }
+
+    // Wait for a free slot. Return false if the queue is closed.
+    template <typename U>
+    bool push(U&& item)
+    {
+        bool is_pushed = false;
+        _not_full.wait([&] { return (is_pushed = try_push(std::forward<U>(item))) || is_closed(); });
+        return is_pushed;
+    }
+
+    // Wait for an item. Return false once the queue is closed and empty.
+    bool pop(T& item)
+    {
+        bool is_popped = false;
+        _not_empty.wait([&] { return (is_popped = try_pop(item)) || is_closed(); });
+        return is_popped;
+    }
+
+    // Wake up every waiting thread: push() fails from now on, pop() once the queue is empty
+    void close()
+    {
+        _closed.store(true);
+        _not_empty.notify_all();
+        _not_full.notify_all();
+    }
+
+    bool is_closed() const
+    {
+        return _closed.load();
+    }
+
+    // Drop the queued items and accept new ones again: only while no producer or consumer is running
+    void reset()
+    {
+        for (size_t i = 0; i < _capacity; ++i)
+        {
+            _cells[i].data = T{};
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        _enqueue_pos.store(0);
+        _dequeue_pos.store(0);
+        _closed.store(false);
+    }
+
+    // Approximate while producers or consumers are running
+    size_t size() const
+    {
+        const size_t enqueue_pos = _enqueue_pos.load(std::memory_order_acquire);
+        const size_t dequeue_pos = _dequeue_pos.load(std::memory_order_acquire);
+        return enqueue_pos > dequeue_pos ? std::min(enqueue_pos - dequeue_pos, _capacity) : 0;
+    }
+
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+private:
+    struct alignas(cache_line_size) cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<cell[]> _cells;
+
+    alignas(cache_line_size) std::atomic<size_t> _enqueue_pos{0};
+    alignas(cache_line_size) std::atomic<size_t> _dequeue_pos{0};
+    alignas(cache_line_size) std::atomic<bool> _closed{false};
+    detail::queue_signal _not_empty;
+    detail::queue_signal _not_full;
+};
+
+}
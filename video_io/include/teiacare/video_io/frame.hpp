@@ -0,0 +1,75 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct AVFrame;
+
+namespace tc::vio
+{
+enum class pixel_format
+{
+    rgb24,
+    bgr24,
+    rgba,
+    bgra,
+    gray8,
+    nv12,
+    yuv420p,
+    native // decoder output planes without any colour conversion
+};
+
+class frame
+{
+public:
+    explicit frame() noexcept;
+    ~frame() noexcept;
+
+    frame(frame&& other) noexcept;
+    frame& operator=(frame&& other) noexcept;
+    frame(const frame&) = delete;
+    frame& operator=(const frame&) = delete;
+
+    bool is_valid() const;
+    void release();
+
+    // Return a new handle that shares the same (read-only) buffers
+    frame share() const;
+
+    // Return a deep copy of the frame, whose buffers are owned exclusively by the returned handle
+    frame copy() const;
+    bool copy_to(uint8_t* buffer, size_t size) const;
+
+    const uint8_t* data(int plane = 0) const;
+    int linesize(int plane = 0) const;
+    int planes() const;
+    pixel_format format() const;
+    const char* format_name() const;
+    int width() const;
+    int height() const;
+    double pts() const;
+    size_t size_in_bytes() const;
+
+private:
+    friend class frame_pool;
+    friend class video_reader;
+
+    AVFrame* _frame;
+    double _pts;
+};
+
+}
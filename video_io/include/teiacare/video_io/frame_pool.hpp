@@ -0,0 +1,80 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/frame.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+struct AVBufferPool;
+struct AVBufferRef;
+struct AVFrame;
+
+namespace tc::vio
+{
+// Recycles the buffers of the frames with a given format, size and alignment.
+// A buffer goes back to the pool once every frame handle sharing it is released, so in steady state getting
+// a frame does not allocate any image memory: new buffers are only allocated while all the others are in use.
+// Frames (and their buffers) can outlive the pool.
+class frame_pool
+{
+public:
+    static constexpr int default_alignment = 64;
+
+    explicit frame_pool(pixel_format format, int width, int height, int alignment = default_alignment) noexcept;
+    ~frame_pool() noexcept;
+
+    frame_pool(const frame_pool&) = delete;
+    frame_pool& operator=(const frame_pool&) = delete;
+
+    // Return the pool shared by everyone asking for the same format, size and alignment, as long as anyone holds it
+    static std::shared_ptr<frame_pool> get_shared(pixel_format format, int width, int height, int alignment = default_alignment);
+
+    bool is_valid() const;
+
+    // Replace the frame content with a writable buffer from the pool (with undefined pixels)
+    bool get(frame& f);
+
+    int width() const;
+    int height() const;
+    int alignment() const;
+    auto get_buffer_size() const -> size_t;
+
+    // Number of buffers allocated so far, i.e. the maximum number of frames ever in use at the same time
+    auto get_high_water_mark() const -> size_t;
+
+private:
+    friend class video_reader;
+
+    explicit frame_pool(int av_pixel_format, int width, int height, int alignment) noexcept;
+    static std::shared_ptr<frame_pool> get_shared(int av_pixel_format, int width, int height, int alignment);
+    static AVBufferRef* allocate_buffer(void* opaque, size_t size);
+
+    bool get(AVFrame* f);
+    bool matches(int av_pixel_format, int width, int height) const;
+
+    const int _av_pixel_format;
+    const int _width;
+    const int _height;
+    const int _alignment;
+    int _linesize[4];
+    size_t _buffer_size;
+    AVBufferPool* _pool;
+    std::atomic<size_t> _allocated_buffers;
+};
+
+}
@@ -0,0 +1,87 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct AVPacket;
+struct AVCodecParameters;
+
+namespace tc::vio
+{
+// Compressed packet of the video stream, as returned by video_reader::read_packet()
+class packet
+{
+public:
+    explicit packet() noexcept;
+    ~packet() noexcept;
+
+    packet(packet&& other) noexcept;
+    packet& operator=(packet&& other) noexcept;
+    packet(const packet&) = delete;
+    packet& operator=(const packet&) = delete;
+
+    bool is_valid() const;
+    void release();
+
+    // Return a new handle that shares the same (read-only) buffer
+    packet share() const;
+
+    const uint8_t* data() const;
+    size_t size() const;
+    double pts() const;      // seconds, -1.0 if unknown
+    double dts() const;      // seconds, -1.0 if unknown
+    double duration() const; // seconds, 0.0 if unknown
+    bool is_keyframe() const;
+    bool is_discontinuity() const; // first packet after the input reconnected: timestamps start over
+
+private:
+    friend class video_reader;
+    friend class video_writer;
+
+    AVPacket* _packet;
+    bool _is_discontinuity;
+};
+
+// Parameters of the video stream needed to decode (or mux) its packets
+class codec_parameters
+{
+public:
+    explicit codec_parameters() noexcept;
+    ~codec_parameters() noexcept;
+
+    codec_parameters(codec_parameters&& other) noexcept;
+    codec_parameters& operator=(codec_parameters&& other) noexcept;
+    codec_parameters(const codec_parameters&) = delete;
+    codec_parameters& operator=(const codec_parameters&) = delete;
+
+    bool is_valid() const;
+    const char* codec_name() const;
+    int width() const;
+    int height() const;
+    const uint8_t* extradata() const; // e.g. H.264 SPS/PPS, as avcC or as Annex-B NAL units
+    size_t extradata_size() const;
+
+private:
+    friend class video_reader;
+    friend class video_writer;
+
+    AVCodecParameters* _parameters;
+    int _time_base_num;
+    int _time_base_den;
+};
+
+}
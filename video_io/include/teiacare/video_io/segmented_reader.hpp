@@ -0,0 +1,102 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/frame.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace tc::vio
+{
+struct segmented_options
+{
+    int worker_count = 0;        // 0: one worker per available core
+    int min_segment_frames = 32; // consecutive GOPs are merged until a segment has at least this many frames
+    bool ordered = true;         // false: frames are returned as soon as any worker decodes them
+    int segment_queue_size = 8;  // ordered mode: decoded frames queued per segment before its worker waits for the caller
+    int window_segments = 0;     // ordered mode: segments decoded ahead of the one being read (0: twice the workers)
+};
+
+// Decodes a file with a pool of workers, each one with its own demuxer and decoder.
+// The file is split at keyframes into segments (using the sidecar index if up to date, a packet scan otherwise)
+// and every worker decodes whole segments. Frames are returned with their index in presentation order,
+// either in order or as soon as they are available.
+// In ordered mode at most window_segments * segment_queue_size decoded frames are queued at any time.
+// A segment that cannot be decoded is never skipped: read() fails from that segment on (see has_error).
+class segmented_reader
+{
+public:
+    explicit segmented_reader() noexcept;
+    ~segmented_reader() noexcept;
+
+    segmented_reader(const segmented_reader&) = delete;
+    segmented_reader& operator=(const segmented_reader&) = delete;
+
+    bool open(const char* video_path, decode_support decode_preference = decode_support::none, const output_options& output_opt = {}, const segmented_options& segmented_opt = {});
+    bool is_opened() const;
+    bool read(frame& f, int* frame_index = nullptr);
+    bool has_error() const; // a segment could not be decoded: read() failed, or will fail, before the end of the file
+    void release();
+
+    auto get_frame_count() const -> std::optional<int>;
+    auto get_frame_size() const -> std::optional<std::tuple<int, int>>;
+    auto get_fps() const -> std::optional<double>;
+    auto get_segment_count() const -> size_t;
+    auto get_worker_count() const -> size_t;
+    auto get_peak_queued_frames() const -> size_t;
+
+private:
+    struct segment;
+    struct frame_queue;
+
+    bool split(const char* video_path);
+    void worker_loop(video_reader& reader);
+    bool next_segment(size_t& s);
+    void decode_segment(video_reader& reader, segment& s);
+    bool push(segment& s, frame&& f, int frame_index);
+    size_t window_size() const;
+
+    segmented_options _options;
+    std::vector<std::unique_ptr<video_reader>> _readers;
+    std::vector<std::unique_ptr<segment>> _segments;
+    std::unique_ptr<frame_queue> _unordered_frames;
+    int _frame_count;
+    int _time_base_num;
+    int _time_base_den;
+
+    size_t _next_segment; // next segment to be decoded
+    size_t _read_segment; // segment being read (ordered mode)
+    size_t _active_workers;
+    bool _stop;
+
+    std::atomic<bool> _has_error;
+    std::atomic<size_t> _queued_frames;
+    std::atomic<size_t> _peak_queued_frames;
+
+    std::mutex _mutex;
+    std::condition_variable _window;
+    std::vector<std::thread> _threads;
+};
+
+}
@@ -0,0 +1,69 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace tc::vio
+{
+// Parameters of the video stream of a file, as detected by an open() that probed it (see video_reader::get_stream_hint).
+// Opening the file again with its hint skips the probing, that decodes the first frames.
+struct stream_hint
+{
+    std::string format_name;       // demuxer, e.g. "mov" or "matroska"
+    int stream_index = -1;
+    std::string codec_name;        // e.g. "h264"
+    std::string pixel_format_name; // decoder output, e.g. "yuv420p"
+    int width = 0;
+    int height = 0;
+    int frame_rate_num = 0;
+    int frame_rate_den = 1;
+    double duration = 0.0; // seconds
+};
+
+// Stream hints keyed by file path, only returned while the file keeps the size and modification time it had when inserted.
+// It can be saved and loaded, to open an archive without probing again in the next runs. Thread-safe.
+class stream_hint_cache
+{
+public:
+    explicit stream_hint_cache() noexcept;
+    ~stream_hint_cache() noexcept;
+
+    auto find(const char* video_path) const -> std::optional<stream_hint>;
+    bool insert(const char* video_path, const stream_hint& hint);
+    void erase(const char* video_path);
+    size_t size() const;
+    void clear();
+
+    bool load(const char* cache_path);
+    bool save(const char* cache_path) const;
+
+private:
+    struct entry
+    {
+        uint64_t file_size;
+        int64_t modification_time;
+        stream_hint hint;
+    };
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, entry> _entries;
+};
+
+}
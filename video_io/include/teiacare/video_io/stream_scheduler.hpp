@@ -0,0 +1,110 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/async_reader.hpp>
+#include <teiacare/video_io/frame.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace tc::vio
+{
+struct scheduler_options
+{
+    int worker_count = 0;                       // 0: one worker per available core
+    std::chrono::milliseconds poll_interval{5}; // delay before polling again a live stream with no packet available
+};
+
+struct stream_options
+{
+    int priority = 1;                                        // frames decoded per turn, relative to the other streams (weighted round robin)
+    size_t queue_capacity = 4;                               // frames kept for read()
+    overflow_policy overflow = overflow_policy::drop_oldest; // block: the stream is not scheduled until a frame is read
+    std::function<void(int, frame&)> on_frame = {};          // if set, called on a worker thread with the stream id instead of queueing
+};
+
+// Decodes many streams on a fixed pool of workers, so that the thread count does not depend on the number of streams.
+// Every stream is decoded on a single thread, one turn at a time: after its turn a stream goes back to the end of the
+// run queue of its worker, and idle workers steal streams from the other run queues.
+// Streams are opened non-blocking, so a live stream with no packet available does not hold a worker (except RTSP,
+// which blocks in read: set input_options::read_timeout to bound it).
+class stream_scheduler
+{
+public:
+    explicit stream_scheduler() noexcept;
+    ~stream_scheduler() noexcept;
+
+    stream_scheduler(const stream_scheduler&) = delete;
+    stream_scheduler& operator=(const stream_scheduler&) = delete;
+
+    bool start(const scheduler_options& scheduler_opt = {});
+    void stop();
+    bool is_running() const;
+
+    // Open a stream (on the caller's thread) and schedule it. Return the stream id, -1 on failure.
+    int add_stream(const char* video_path, decode_support decode_preference = decode_support::none, const output_options& output_opt = {}, const stream_options& stream_opt = {}, const input_options& input_opt = {});
+
+    // Once it returns, no callback is running or will be called for this stream (a blocking read is interrupted)
+    bool remove_stream(int stream_id);
+
+    bool read(int stream_id, frame& f);
+    bool try_read(int stream_id, frame& f);
+    bool is_end_of_stream(int stream_id) const;
+
+    auto get_stream_count() const -> size_t;
+    auto get_worker_count() const -> size_t;
+    auto get_dropped_frame_count(int stream_id) const -> uint64_t;
+
+private:
+    struct stream;
+    struct run_queue;
+    using stream_ptr = std::shared_ptr<stream>;
+
+    void worker_loop(size_t worker);
+    void run(size_t worker, const stream_ptr& s);
+    void deliver(stream& s);
+    void park(stream_ptr s);
+    void resume(stream_ptr s);
+    void push(size_t worker, stream_ptr s);
+    stream_ptr pop(size_t worker);
+    stream_ptr find_stream(int stream_id) const;
+    bool take_frame(const stream_ptr& s, frame& f, bool wait);
+
+    scheduler_options _options;
+    std::vector<std::unique_ptr<run_queue>> _run_queues;
+    std::unordered_map<int, stream_ptr> _streams;
+    std::multimap<std::chrono::steady_clock::time_point, stream_ptr> _parked_streams; // live streams waiting for input
+    size_t _runnable_streams;
+    size_t _next_worker;
+    int _next_stream_id;
+    bool _stop;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _work_available;
+    std::condition_variable _stream_idle;
+    std::vector<std::thread> _threads;
+};
+
+}
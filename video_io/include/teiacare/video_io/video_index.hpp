@@ -0,0 +1,86 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct AVFormatContext;
+
+namespace tc::vio
+{
+struct index_entry
+{
+    int64_t pts; // stream time base
+    int64_t dts; // stream time base
+    int64_t pos; // byte offset in the file, -1 if unknown
+    int size;
+    bool keyframe;
+};
+
+// Packet index of the video stream of a file, built by demuxing only (no decoding).
+// It is saved in a sidecar file ("<video_path>.vioidx") that video_reader loads on open().
+class video_index
+{
+public:
+    explicit video_index() noexcept;
+    ~video_index() noexcept;
+
+    // Index the packets of the video stream. When this index already covers the same file and the file has only grown
+    // since (e.g. a recording still in progress), only the new packets are scanned.
+    bool build(const char* video_path);
+    bool load(const char* video_path);
+    bool save(const char* video_path) const;
+    bool is_up_to_date(const char* video_path) const;
+    void clear();
+
+    static std::string get_sidecar_path(const char* video_path);
+
+    auto get_entries() const -> const std::vector<index_entry>&;
+    auto get_frame_count() const -> std::optional<int>;
+    auto get_stream_index() const -> int;
+    auto get_time_base() const -> std::tuple<int, int>;
+
+    // Keyframe with the largest pts not greater than the given timestamp (stream time base)
+    auto find_keyframe(int64_t timestamp) const -> std::optional<index_entry>;
+
+    // Timestamp (stream time base) of the frame at the given position in presentation order
+    auto get_frame_timestamp(int frame_index) const -> std::optional<int64_t>;
+
+    // Position in presentation order of the first frame whose timestamp is not less than the given one
+    auto get_frame_index(int64_t timestamp) const -> std::optional<int>;
+
+    // Timestamps (stream time base) of all the keyframes, in presentation order
+    auto get_keyframe_timestamps() const -> std::vector<int64_t>;
+
+private:
+    bool scan(AVFormatContext* fmt_ctx, int64_t resume_dts);
+    void update_lookup_tables();
+    void reset(AVFormatContext* fmt_ctx);
+
+    std::vector<index_entry> _entries;
+    std::vector<int64_t> _sorted_pts;
+    std::vector<size_t> _keyframes; // entry positions, sorted by pts
+    int _stream_index;
+    int _time_base_num;
+    int _time_base_den;
+    uint64_t _file_size;
+    uint64_t _file_prefix_hash;
+};
+
+}
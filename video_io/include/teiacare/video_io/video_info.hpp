@@ -14,6 +14,9 @@
 
 #pragma once
 
+#include <teiacare/video_io/stream_hint.hpp>
+
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -39,7 +42,8 @@ public:
     explicit video_info() noexcept;
     ~video_info() noexcept;
 
-    std::optional<video_metadata> get_video_metadata(const std::string& video_path);
+    // With a hint cache, the files already probed are not probed again (see video_reader input_options::hint_cache)
+    std::optional<video_metadata> get_video_metadata(const std::string& video_path, const std::shared_ptr<stream_hint_cache>& hint_cache = {});
 
 private:
     void reset(AVFormatContext* fmt_ctx);
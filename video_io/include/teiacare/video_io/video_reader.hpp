@@ -14,10 +14,15 @@
 
 #pragma once
 
+#include <teiacare/video_io/frame.hpp>
+#include <teiacare/video_io/packet.hpp>
+#include <teiacare/video_io/stream_hint.hpp>
+
 #include <chrono>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 struct AVFormatContext;
 struct AVCodecContext;
@@ -27,9 +32,14 @@ struct AVFrame;
 struct SwsContext;
 struct AVDictionary;
 struct AVInputFormat;
+struct AVBSFContext;
 
 namespace tc::vio
 {
+class frame_pool;
+class slice_pool;
+class video_index;
+
 enum class decode_support
 {
     none,
@@ -40,6 +50,122 @@ struct screen_options
 {
 };
 
+enum class decode_threading
+{
+    automatic,
+    frame,
+    slice
+};
+
+struct decode_options
+{
+    int thread_count = 0; // 0: pick a default based on codec, resolution and available cores
+    decode_threading threading = decode_threading::automatic;
+    bool keyframes_only = false; // skip all non-key packets before decoding (thumbnails, coarse search)
+    int frame_step = 1;          // return one every frame_step decoded frames
+    double target_fps = 0.0;     // 0: disabled. Return frames at this rate, selected by timestamp (takes precedence over frame_step)
+    int pipeline_depth = 0;      // 0: demux, decode and convert on the caller's thread. >0: one thread per stage, with queues of this size (rounded up to a power of two)
+    bool non_blocking = false;   // live inputs: read() fails immediately while no packet is available (see is_end_of_stream)
+    bool annexb = false;         // read_packet(): H.264/HEVC with start codes (as in .h264 files and MPEG-TS) instead of length prefixes (MP4, MKV)
+    bool latest_frame = false;   // live inputs: demux and decode on a background thread, read() converts only the newest frame and skips the older ones
+};
+
+enum class rtsp_transport
+{
+    tcp,
+    udp // lower latency, but lost packets are not retransmitted
+};
+
+struct input_options
+{
+    rtsp_transport transport = rtsp_transport::tcp;
+    int64_t probe_size = 0;                              // bytes read to detect the streams on open(), 0: FFmpeg default (5 MB)
+    int64_t analyze_duration = 0;                        // microseconds of input analysed to detect the streams on open(), 0: FFmpeg default (5 s)
+    bool no_buffer = false;                              // do not buffer the packets read while detecting the streams (fflags nobuffer)
+    bool discard_corrupt = false;                        // drop the packets flagged as corrupted (fflags discardcorrupt)
+    int max_delay = -1;                                  // microseconds the demuxer may wait to reorder packets (RTP over UDP), -1: FFmpeg default
+    int reorder_queue_size = -1;                         // packets buffered to reorder RTP over UDP, -1: FFmpeg default
+    bool low_delay = false;                              // decoder outputs every frame as soon as possible (AV_CODEC_FLAG_LOW_DELAY)
+    bool rtsp_listen = false;                            // act as the RTSP server that a camera or an encoder pushes to (RECORD)
+    std::optional<stream_hint> hint = {};                // stream parameters of a previous open(): no probing, unless they do not match the input
+    std::shared_ptr<stream_hint_cache> hint_cache = {};  // hint looked up by path when none is given, and updated after probing
+    std::chrono::milliseconds open_timeout{0};           // longest open(), connection and probing included. 0: no deadline
+    std::chrono::milliseconds read_timeout{0};           // longest wait for data within a single read from the input. 0: no deadline
+    std::chrono::milliseconds idle_timeout{0};           // longest time without any packet of the video stream (non-blocking reads included). 0: no deadline
+    int reconnect_attempts = 0;                          // live inputs: reconnect after a timeout or a lost connection, -1: unlimited
+    std::chrono::milliseconds reconnect_delay{100};      // wait after a failed reconnection attempt, doubled after each one
+    std::chrono::milliseconds max_reconnect_delay{5000}; // upper bound of reconnect_delay
+
+    // Live cameras: open in a fraction of a second and keep as few frames as possible in flight
+    static input_options low_latency()
+    {
+        return {.probe_size = 500000, .analyze_duration = 500000, .no_buffer = true, .discard_corrupt = true, .max_delay = 50000, .reorder_queue_size = 64, .low_delay = true};
+    }
+};
+
+struct stage_stats
+{
+    std::chrono::nanoseconds busy{0}; // processing
+    std::chrono::nanoseconds idle{0}; // waiting for input or for space in the next queue
+    uint64_t items = 0;
+};
+
+struct pipeline_stats
+{
+    stage_stats demux;
+    stage_stats decode;
+    stage_stats convert;
+};
+
+enum class interpolation
+{
+    nearest,
+    fast_bilinear,
+    bilinear,
+    bicubic,
+    area
+};
+
+enum class color_matrix
+{
+    automatic, // from the stream, BT.601 if not specified
+    bt601,
+    bt709
+};
+
+enum class color_range
+{
+    automatic, // from the stream, limited if not specified
+    limited,
+    full
+};
+
+struct output_options
+{
+    pixel_format format = pixel_format::rgb24;
+    int width = 0;  // 0: keep the input width (or preserve the aspect ratio if only height is set)
+    int height = 0; // 0: keep the input height (or preserve the aspect ratio if only width is set)
+    interpolation resize_interpolation = interpolation::bilinear;
+    bool allow_lowres = true;                          // let codecs that support it decode directly at a reduced resolution
+    color_matrix yuv_matrix = color_matrix::automatic; // YUV to RGB conversion coefficients
+    color_range yuv_range = color_range::automatic;    // range of the decoded YUV samples
+    bool simd_conversion = true;                       // YUV420P/NV12 to RGB24/BGR24/RGBA/BGRA without resize: built-in SIMD kernels instead of swscale
+    int conversion_threads = 1;                        // >1: every frame is converted in horizontal bands on this many threads (same output as with 1)
+    std::shared_ptr<frame_pool> pool = {};             // output buffers: if not set (or not matching), the shared pool of the output format and size
+};
+
+enum class tensor_layout
+{
+    nhwc, // frames back to back, each one with tightly packed rows (e.g. RGBRGB...)
+    nchw  // frames back to back, each one with one plane per channel (e.g. RR...GG...BB...). RGB(A), BGR(A) and GRAY8 only.
+};
+
+enum class seek_mode
+{
+    fast, // land on the keyframe at or before the target
+    exact // decode forward from the keyframe and land on the frame closest to the target
+};
+
 class video_reader
 {
 public:
@@ -49,25 +175,84 @@ public:
     // using log_callback_t = std::function<void(const std::string&)>;
     // void set_log_callback(const log_callback_t& cb, const log_level& level = log_level::all);
 
-    bool open(const char* video_path, decode_support decode_preference = decode_support::none);
+    bool open(const char* video_path, decode_support decode_preference = decode_support::none, const decode_options& decode_opt = {}, const output_options& output_opt = {}, const input_options& input_opt = {});
     bool open(const char* screen_name, screen_options screen_opt);
     bool is_opened() const;
     bool read(uint8_t** data, double* pts = nullptr);
+    bool read(frame& f);
+    bool read_into(uint8_t* buffer, int stride, size_t size, double* pts = nullptr);
+    int read_batch(uint8_t* buffer, size_t size, int batch_size, double* pts = nullptr, tensor_layout layout = tensor_layout::nhwc);
+    bool read_packet(packet& p); // compressed packets, without decoding: do not mix with the other read functions
+    bool seek(double seconds, seek_mode mode = seek_mode::exact, double* landing_pts = nullptr);
+    bool seek_frame(int frame_index, seek_mode mode = seek_mode::exact, double* landing_pts = nullptr);
     void release();
+    void interrupt(); // thread-safe: aborts a blocking read or a reconnection, read() then fails until release() or open()
 
     auto get_frame_count() const -> std::optional<int>;
     auto get_duration() const -> std::optional<std::chrono::steady_clock::duration>;
     auto get_frame_size() const -> std::optional<std::tuple<int, int>>;
     auto get_frame_size_in_bytes() const -> std::optional<int>;
     auto get_fps() const -> std::optional<double>;
+    auto get_decode_thread_count() const -> std::optional<int>;
+    bool has_index() const;
+    bool is_end_of_stream() const;
+    bool is_probed() const;
+    auto get_reconnect_count() const -> std::optional<int>;
+    auto get_pipeline_stats() const -> std::optional<pipeline_stats>;
+    auto get_skipped_frame_count() const -> std::optional<uint64_t>; // decode_options::latest_frame only
+    auto get_frame_pool() const -> std::shared_ptr<frame_pool>;
+    auto get_codec_parameters() const -> std::optional<codec_parameters>;
+    auto get_stream_hint() const -> std::optional<stream_hint>;
+
+    // Required alignment (in bytes) of both the buffer address and the stride passed to read_into()
+    static constexpr size_t buffer_alignment = 16;
 
 protected:
     void init();
+    bool setup_input_options();
     bool open_input(const char* input, const AVInputFormat* input_format);
+    void setup_demuxer();
+    void setup_threading(const AVCodec* codec);
+    void setup_lowres(const AVCodec* codec);
+    void setup_output_size();
+    void setup_frame_pool();
+    void load_index(const char* video_path);
+    void setup_subsampling();
+    bool setup_bitstream_filter();
+    int read_packet();
+    int demux_packet(AVPacket* packet);
+    bool is_live_input() const;
+    bool reconnect();
+    AVFormatContext* reopen_input(const std::optional<stream_hint>& hint);
+    bool is_same_stream(AVFormatContext* fmt_ctx, const std::optional<stream_hint>& previous) const;
     bool decode();
-    bool convert(uint8_t** data, double* pts);
+    bool check_first_frame();
+    bool next_frame();
+    bool is_frame_selected();
+    bool is_frame_dropped(int64_t timestamp) const;
+    bool seek_timestamp(int64_t timestamp, seek_mode mode, double* landing_pts);
+    bool seek_decoder(int64_t timestamp, seek_mode mode, double* landing_pts);
+    int64_t get_frame_duration() const;
+    bool convert();
+    bool scale(uint8_t* const dst_data[], const int dst_linesize[], int dst_pixel_format);
+    bool scale_threaded(uint8_t* const dst_data[], const int dst_linesize[], int dst_pixel_format);
+    bool setup_threaded_sws_context(int dst_pixel_format);
+    AVFrame* get_scale_frame(uint8_t* const dst_data[], const int dst_linesize[], int dst_pixel_format);
+    bool convert_yuv_to_rgb(const AVFrame* src, uint8_t* dst, int dst_linesize, int dst_pixel_format);
+    void setup_colorspace(SwsContext* sws_ctx, const AVFrame* src, int dst_pixel_format) const;
+    bool is_bt709(const AVFrame* src) const;
+    bool is_full_range(const AVFrame* src) const;
+    int get_sws_flags() const;
+    bool fill_planes(uint8_t* buffer, int stride, size_t size, uint8_t* dst_data[], int dst_linesize[]) const;
+    int fill_tensor_planes(uint8_t* buffer, tensor_layout layout, uint8_t* dst_data[], int dst_linesize[]) const;
+    int get_output_pixel_format() const;
+    bool is_passthrough() const;
+    bool is_reusable(const frame& f) const;
+    AVFrame* get_output_frame() const;
+    bool make_dst_frame_writable();
+    double get_pts(const AVFrame* frame) const;
     bool reset_data(uint8_t** data, double* pts) const;
-    bool flush();
+    void flush();
     bool copy_hw_frame();
 
 private:
@@ -75,17 +260,58 @@ private:
     AVCodecContext* _codec_ctx;
     SwsContext* _sws_ctx;
     AVPacket* _packet;
+    AVBSFContext* _bsf_ctx;
 
     AVFrame* _src_frame;
     AVFrame* _dst_frame;
     AVFrame* _tmp_frame;
+    AVFrame* _hw_frame;
+    AVFrame* _ready_frame;
+    std::vector<AVFrame*> _scale_frames; // sws_scale_frame() destinations, each one wrapping the planes of an output buffer
 
     decode_support _decode_support;
+    input_options _input_options;
+    decode_options _decode_options;
+    output_options _output_options;
+    int _output_width;
+    int _output_height;
     AVDictionary* _options;
+    std::string _input_path;
     int _stream_index;
 
+    // Copied from the stream on open(): the caller's thread never reads the demuxer context, that a reconnection may replace
+    struct stream_properties
+    {
+        int time_base_num = 0;
+        int time_base_den = 1;
+        int frame_rate_num = 0;
+        int frame_rate_den = 1;
+        int64_t start_time = 0;  // stream time base
+        int64_t frame_count = 0; // 0: unknown
+        int64_t duration = 0;    // AV_TIME_BASE units
+    };
+    stream_properties _stream_properties;
+
+    bool _has_pending_frame;
+    bool _is_waiting_for_input;
+    bool _is_end_of_stream;
+    bool _is_probed;
+    bool _is_hint_rejected;
+    int64_t _decoded_frame_count;
+    int64_t _select_interval;
+    int64_t _next_select_timestamp;
+
     struct hw_acceleration;
     std::unique_ptr<hw_acceleration> _hw;
+    std::unique_ptr<video_index> _index;
+    std::shared_ptr<frame_pool> _frame_pool;
+    std::unique_ptr<slice_pool> _slice_pool;
+
+    struct io_control;
+    std::unique_ptr<io_control> _io;
+
+    struct pipeline;
+    std::unique_ptr<pipeline> _pipeline;
 };
 
 }
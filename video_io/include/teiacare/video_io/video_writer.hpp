@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <teiacare/video_io/packet.hpp>
+
 #include <chrono>
 #include <memory>
 #include <optional>
@@ -40,8 +42,10 @@ public:
 
     bool open(const std::string& video_path, int width, int height, const int fps);
     bool open(const std::string& video_path, int width, int height, const int fps, const int duration);
+    bool open(const std::string& video_path, const codec_parameters& parameters); // stream copy (remux) of packets, without encoding
     bool is_opened() const;
     bool write(const uint8_t* data);
+    bool write_packet(const packet& p);
     bool release();
     bool save();
 
@@ -49,6 +53,8 @@ public:
 
 protected:
     void init();
+    bool open_output(const std::string& video_path);
+    bool write_header(const std::string& video_path);
     bool convert(const uint8_t* data);
     bool encode(AVFrame* frame);
     AVFrame* alloc_frame(int pix_fmt, int width, int height);
@@ -65,6 +71,10 @@ private:
     AVStream* _stream;
     int64_t _stream_duration;
     int64_t _next_pts;
+
+    bool _is_stream_copy;
+    int64_t _start_timestamp;
+    int64_t _last_dts;
 };
 
 }
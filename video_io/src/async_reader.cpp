@@ -0,0 +1,234 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/async_reader.hpp>
+
+#include "logger.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace tc::vio
+{
+async_reader::async_reader() noexcept
+    : _reader{std::make_unique<video_reader>()}
+    , _head{0}
+    , _size{0}
+    , _dropped_frames{0}
+    , _is_decoding{false}
+    , _stop{false}
+{
+}
+
+async_reader::~async_reader() noexcept
+{
+    release();
+}
+
+bool async_reader::open(const char* video_path, decode_support decode_preference, const decode_options& decode_opt, const output_options& output_opt, const async_options& async_opt, const input_options& input_opt)
+{
+    release();
+
+    if (!_reader->open(video_path, decode_preference, decode_opt, output_opt, input_opt))
+        return false;
+
+    _options = async_opt;
+    _options.capacity = std::max<size_t>(1, _options.capacity);
+
+    _ring.clear();
+    _ring.resize(_options.capacity);
+    _head = 0;
+    _size = 0;
+    _dropped_frames = 0;
+    _is_decoding = true;
+    _stop = false;
+
+    _thread = std::thread(&async_reader::decode_loop, this);
+    log_info("Async reader started, capacity:", _options.capacity);
+    return true;
+}
+
+bool async_reader::is_opened() const
+{
+    return _reader->is_opened();
+}
+
+void async_reader::release()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _not_full.notify_all();
+    _not_empty.notify_all();
+
+    // The decode thread may be blocked in a read on a stalled live input
+    _reader->interrupt();
+
+    if (_thread.joinable())
+        _thread.join();
+
+    _reader->release();
+    _ring.clear();
+    _head = 0;
+    _size = 0;
+    _is_decoding = false;
+}
+
+void async_reader::decode_loop()
+{
+    const size_t capacity = _ring.size();
+    frame f;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(_mutex);
+            if (_options.overflow == overflow_policy::block)
+                _not_full.wait(lock, [this, capacity] { return _stop || _size < capacity; });
+
+            if (_stop)
+                break;
+
+            // Take the buffer left in the next free slot (by a previous frame or by the caller), so it is decoded into
+            if (_size < capacity)
+                std::swap(f, _ring[(_head + _size) % capacity]);
+        }
+
+        // Decode and convert without holding the lock
+        const bool has_frame = _reader->read(f);
+
+        std::unique_lock lock(_mutex);
+        if (_stop || !has_frame)
+            break;
+
+        if (_size == capacity)
+        {
+            ++_dropped_frames;
+
+            // drop_newest: keep the frame buffer for the next decode
+            if (_options.overflow == overflow_policy::drop_newest)
+                continue;
+
+            // drop_oldest: the oldest slot becomes the free slot the new frame is stored in
+            _head = (_head + 1) % capacity;
+            --_size;
+        }
+
+        std::swap(f, _ring[(_head + _size) % capacity]);
+        ++_size;
+
+        lock.unlock();
+        _not_empty.notify_one();
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+        _is_decoding = false;
+    }
+    _not_empty.notify_all();
+}
+
+void async_reader::pop(frame& f)
+{
+    // The caller's previous frame goes back to the ring, where its buffer is reused by the decoder
+    std::swap(f, _ring[_head]);
+    _head = (_head + 1) % _ring.size();
+    --_size;
+}
+
+bool async_reader::read(frame& f)
+{
+    {
+        std::unique_lock lock(_mutex);
+        _not_empty.wait(lock, [this] { return _size > 0 || !_is_decoding; });
+        if (_size == 0)
+        {
+            f.release();
+            return false;
+        }
+
+        pop(f);
+    }
+
+    _not_full.notify_one();
+    return true;
+}
+
+bool async_reader::try_read(frame& f)
+{
+    {
+        std::lock_guard lock(_mutex);
+        if (_size == 0)
+            return false;
+
+        pop(f);
+    }
+
+    _not_full.notify_one();
+    return true;
+}
+
+bool async_reader::read_for(frame& f, std::chrono::steady_clock::duration timeout)
+{
+    {
+        std::unique_lock lock(_mutex);
+        if (!_not_empty.wait_for(lock, timeout, [this] { return _size > 0 || !_is_decoding; }) || _size == 0)
+        {
+            f.release();
+            return false;
+        }
+
+        pop(f);
+    }
+
+    _not_full.notify_one();
+    return true;
+}
+
+bool async_reader::is_end_of_stream() const
+{
+    std::lock_guard lock(_mutex);
+    return !_is_decoding && _size == 0;
+}
+
+auto async_reader::get_frame_size() const -> std::optional<std::tuple<int, int>>
+{
+    return _reader->get_frame_size();
+}
+
+auto async_reader::get_fps() const -> std::optional<double>
+{
+    return _reader->get_fps();
+}
+
+auto async_reader::get_queue_size() const -> size_t
+{
+    std::lock_guard lock(_mutex);
+    return _size;
+}
+
+auto async_reader::get_queue_capacity() const -> size_t
+{
+    std::lock_guard lock(_mutex);
+    return _ring.size();
+}
+
+auto async_reader::get_dropped_frame_count() const -> uint64_t
+{
+    std::lock_guard lock(_mutex);
+    return _dropped_frames;
+}
+
+}
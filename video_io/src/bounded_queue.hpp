@@ -0,0 +1,112 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace tc::vio
+{
+// Blocking queue with a maximum size, used to connect the stages of the video_reader pipeline.
+// close() wakes up every waiting thread: push() then fails and pop() fails once the queue is empty.
+template <typename T>
+class bounded_queue
+{
+public:
+    explicit bounded_queue(size_t max_size)
+        : _max_size{std::max<size_t>(1, max_size)}
+        , _is_closed{false}
+    {
+    }
+
+    bool push(T item)
+    {
+        std::unique_lock lock(_mutex);
+        _not_full.wait(lock, [this] { return _is_closed || _queue.size() < _max_size; });
+        if (_is_closed)
+            return false;
+
+        _queue.push_back(std::move(item));
+        lock.unlock();
+        _not_empty.notify_one();
+        return true;
+    }
+
+    bool pop(T& item)
+    {
+        std::unique_lock lock(_mutex);
+        _not_empty.wait(lock, [this] { return _is_closed || !_queue.empty(); });
+        if (_queue.empty())
+            return false;
+
+        item = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+        _not_full.notify_one();
+        return true;
+    }
+
+    // Replace the queued items instead of waiting for space (dropped: how many were replaced before being popped)
+    bool push_latest(T item, size_t& dropped)
+    {
+        std::unique_lock lock(_mutex);
+        if (_is_closed)
+            return false;
+
+        dropped = _queue.size();
+        _queue.clear();
+        _queue.push_back(std::move(item));
+        lock.unlock();
+        _not_empty.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _is_closed = true;
+        }
+        _not_full.notify_all();
+        _not_empty.notify_all();
+    }
+
+    // Drop all the queued items and accept new ones again
+    void reset()
+    {
+        std::lock_guard lock(_mutex);
+        _queue.clear();
+        _is_closed = false;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard lock(_mutex);
+        return _queue.size();
+    }
+
+private:
+    const size_t _max_size;
+    bool _is_closed;
+    std::deque<T> _queue;
+    mutable std::mutex _mutex;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+};
+
+}
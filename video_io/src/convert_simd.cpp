@@ -0,0 +1,180 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "convert_simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(TC_VIO_X86_SIMD) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace tc::vio::simd
+{
+namespace
+{
+enum class instruction_set
+{
+    scalar,
+    sse41,
+    avx2
+};
+
+instruction_set detect_instruction_set()
+{
+#if defined(TC_VIO_X86_SIMD) && defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    const bool has_sse41 = (info[2] & (1 << 19)) != 0;
+    const bool has_avx = (info[2] & (1 << 28)) != 0;
+    const bool has_os_avx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6; // OS saves the YMM registers
+
+    bool has_avx2 = false;
+    if (max_leaf >= 7 && has_avx && has_os_avx)
+    {
+        __cpuidex(info, 7, 0);
+        has_avx2 = (info[1] & (1 << 5)) != 0;
+    }
+
+    return has_avx2 ? instruction_set::avx2 : (has_sse41 ? instruction_set::sse41 : instruction_set::scalar);
+#elif defined(TC_VIO_X86_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return instruction_set::avx2;
+
+    return __builtin_cpu_supports("sse4.1") ? instruction_set::sse41 : instruction_set::scalar;
+#else
+    return instruction_set::scalar;
+#endif
+}
+
+instruction_set get_best_instruction_set()
+{
+    static const instruction_set best = detect_instruction_set();
+    return best;
+}
+
+detail::row_function get_row(yuv_format src_format, rgb_format dst_format)
+{
+    detail::row_function row = nullptr;
+    switch (get_best_instruction_set())
+    {
+    case instruction_set::avx2:
+        row = detail::get_avx2_row(src_format, dst_format);
+        break;
+    case instruction_set::sse41:
+        row = detail::get_sse41_row(src_format, dst_format);
+        break;
+    default:
+        break;
+    }
+
+    return row ? row : detail::get_scalar_row(src_format, dst_format);
+}
+
+struct scalar_kernel
+{
+    template <yuv_format Src, rgb_format Dst>
+    static void row(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const yuv_coefficients& c)
+    {
+        constexpr bool is_bgr = Dst == rgb_format::bgr24 || Dst == rgb_format::bgra;
+        constexpr bool has_alpha = Dst == rgb_format::rgba || Dst == rgb_format::bgra;
+        constexpr int pixel_size = has_alpha ? 4 : 3;
+
+        auto clamp = [](int value) { return static_cast<uint8_t>(std::clamp(value >> 13, 0, 255)); };
+
+        for (int x = 0; x < width; ++x, dst += pixel_size)
+        {
+            const int cu = (Src == yuv_format::nv12 ? u[x & ~1] : u[x / 2]) - 128;
+            const int cv = (Src == yuv_format::nv12 ? u[x | 1] : v[x / 2]) - 128;
+            const int luma = (y[x] - c.y_offset) * c.y + 4096;
+
+            const uint8_t r = clamp(luma + c.r_v * cv);
+            const uint8_t g = clamp(luma + c.g_u * cu + c.g_v * cv);
+            const uint8_t b = clamp(luma + c.b_u * cu);
+
+            dst[0] = is_bgr ? b : r;
+            dst[1] = g;
+            dst[2] = is_bgr ? r : b;
+            if constexpr (has_alpha)
+                dst[3] = 255;
+        }
+    }
+};
+}
+
+yuv_coefficients get_yuv_coefficients(bool is_bt709, bool is_full_range)
+{
+    const double kr = is_bt709 ? 0.2126 : 0.299;
+    const double kb = is_bt709 ? 0.0722 : 0.114;
+    const double kg = 1.0 - kr - kb;
+
+    // Limited range: luma in [16, 235], chroma in [16, 240]
+    const double y_scale = is_full_range ? 1.0 : 255.0 / 219.0;
+    const double c_scale = is_full_range ? 1.0 : 255.0 / 224.0;
+
+    auto q13 = [](double value) { return static_cast<int16_t>(std::lround(value * 8192.0)); };
+
+    yuv_coefficients c;
+    c.y_offset = is_full_range ? 0 : 16;
+    c.y = q13(y_scale);
+    c.r_v = q13(c_scale * 2.0 * (1.0 - kr));
+    c.g_u = q13(-c_scale * 2.0 * (1.0 - kb) * kb / kg);
+    c.g_v = q13(-c_scale * 2.0 * (1.0 - kr) * kr / kg);
+    c.b_u = q13(c_scale * 2.0 * (1.0 - kb));
+    return c;
+}
+
+void yuv_to_rgb(const yuv_planes& src, yuv_format src_format, uint8_t* dst, int dst_linesize, rgb_format dst_format, int width, int first_row, int last_row, const yuv_coefficients& c)
+{
+    const auto row = get_row(src_format, dst_format);
+    const bool is_nv12 = src_format == yuv_format::nv12;
+
+    for (int i = first_row; i < last_row; ++i)
+    {
+        const uint8_t* y = src.data[0] + static_cast<ptrdiff_t>(i) * src.linesize[0];
+        const uint8_t* u = src.data[1] + static_cast<ptrdiff_t>(i / 2) * src.linesize[1];
+        const uint8_t* v = is_nv12 ? nullptr : src.data[2] + static_cast<ptrdiff_t>(i / 2) * src.linesize[2];
+        row(y, u, v, dst + static_cast<ptrdiff_t>(i) * dst_linesize, width, c);
+    }
+}
+
+const char* get_instruction_set()
+{
+    switch (get_best_instruction_set())
+    {
+    case instruction_set::avx2:
+        return "avx2";
+    case instruction_set::sse41:
+        return "sse4.1";
+    default:
+        return "scalar";
+    }
+}
+
+namespace detail
+{
+row_function get_scalar_row(yuv_format src_format, rgb_format dst_format)
+{
+    return select_row<scalar_kernel>(src_format, dst_format);
+}
+}
+
+}
@@ -0,0 +1,92 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+// YUV 4:2:0 to packed RGB conversion without resize, with AVX2, SSE4.1 or scalar kernels picked at runtime.
+// Every kernel computes the same fixed point expressions, so the output does not depend on the instruction set.
+namespace tc::vio::simd
+{
+enum class yuv_format
+{
+    yuv420p,
+    nv12
+};
+
+enum class rgb_format
+{
+    rgb24,
+    bgr24,
+    rgba,
+    bgra
+};
+
+// Q13 fixed point: channel = ((y - y_offset) * y + u_coefficient * (u - 128) + v_coefficient * (v - 128) + 4096) >> 13
+struct yuv_coefficients
+{
+    int16_t y_offset;
+    int16_t y;
+    int16_t r_v;
+    int16_t g_u;
+    int16_t g_v;
+    int16_t b_u;
+};
+
+yuv_coefficients get_yuv_coefficients(bool is_bt709, bool is_full_range);
+
+struct yuv_planes
+{
+    const uint8_t* data[3]; // Y, U, V (NV12: Y, interleaved UV)
+    int linesize[3];
+};
+
+// Convert the rows [first_row, last_row): chroma samples are shared by 2x2 pixels (no interpolation)
+void yuv_to_rgb(const yuv_planes& src, yuv_format src_format, uint8_t* dst, int dst_linesize, rgb_format dst_format, int width, int first_row, int last_row, const yuv_coefficients& c);
+
+// "avx2", "sse4.1" or "scalar"
+const char* get_instruction_set();
+
+namespace detail
+{
+// One row of pixels. NV12: u points to the interleaved UV row and v is not used.
+using row_function = void (*)(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const yuv_coefficients& c);
+
+// Kernel: a type with a static template <yuv_format, rgb_format> row() function
+template <typename Kernel>
+row_function select_row(yuv_format src_format, rgb_format dst_format)
+{
+    const bool is_nv12 = src_format == yuv_format::nv12;
+    switch (dst_format)
+    {
+    case rgb_format::rgb24:
+        return is_nv12 ? &Kernel::template row<yuv_format::nv12, rgb_format::rgb24> : &Kernel::template row<yuv_format::yuv420p, rgb_format::rgb24>;
+    case rgb_format::bgr24:
+        return is_nv12 ? &Kernel::template row<yuv_format::nv12, rgb_format::bgr24> : &Kernel::template row<yuv_format::yuv420p, rgb_format::bgr24>;
+    case rgb_format::rgba:
+        return is_nv12 ? &Kernel::template row<yuv_format::nv12, rgb_format::rgba> : &Kernel::template row<yuv_format::yuv420p, rgb_format::rgba>;
+    case rgb_format::bgra:
+    default:
+        return is_nv12 ? &Kernel::template row<yuv_format::nv12, rgb_format::bgra> : &Kernel::template row<yuv_format::yuv420p, rgb_format::bgra>;
+    }
+}
+
+// nullptr when the instruction set is not available on this architecture (see TC_VIO_X86_SIMD)
+row_function get_scalar_row(yuv_format src_format, rgb_format dst_format);
+row_function get_sse41_row(yuv_format src_format, rgb_format dst_format);
+row_function get_avx2_row(yuv_format src_format, rgb_format dst_format);
+}
+
+}
@@ -0,0 +1,129 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Built with AVX2 enabled (see CMakeLists.txt): only called after checking the CPU at runtime
+
+#include "convert_simd.hpp"
+
+#if defined(TC_VIO_X86_SIMD)
+#include "convert_simd_x86.hpp"
+
+namespace tc::vio::simd
+{
+namespace
+{
+struct avx2_kernel
+{
+    struct coefficients
+    {
+        __m256i y;
+        __m256i r;
+        __m256i g;
+        __m256i b;
+    };
+
+    // 16 pixels, as 16 bit samples without their offsets, to 16 bit channels.
+    // Unpacking and packing both work within 128 bit lanes, so the pixels keep their order.
+    static void convert(__m256i y, __m256i u, __m256i v, const coefficients& c, __m256i& r, __m256i& g, __m256i& b)
+    {
+        const __m256i one = _mm256_set1_epi16(1);
+        const __m256i luma_low = _mm256_madd_epi16(_mm256_unpacklo_epi16(y, one), c.y);
+        const __m256i luma_high = _mm256_madd_epi16(_mm256_unpackhi_epi16(y, one), c.y);
+        const __m256i uv_low = _mm256_unpacklo_epi16(u, v);
+        const __m256i uv_high = _mm256_unpackhi_epi16(u, v);
+
+        auto channel = [&](__m256i coefficients) {
+            const __m256i low = _mm256_srai_epi32(_mm256_add_epi32(luma_low, _mm256_madd_epi16(uv_low, coefficients)), 13);
+            const __m256i high = _mm256_srai_epi32(_mm256_add_epi32(luma_high, _mm256_madd_epi16(uv_high, coefficients)), 13);
+            return _mm256_packs_epi32(low, high);
+        };
+
+        r = channel(c.r);
+        g = channel(c.g);
+        b = channel(c.b);
+    }
+
+    // 16 bit channels of 2 x 16 pixels to 8 bit: packus interleaves the 128 bit lanes, the permutation restores the order
+    static __m256i pack(__m256i first, __m256i second)
+    {
+        return _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8);
+    }
+
+    template <yuv_format Src, rgb_format Dst>
+    static void row(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const yuv_coefficients& c)
+    {
+        constexpr int pixel_size = Dst == rgb_format::rgb24 || Dst == rgb_format::bgr24 ? 3 : 4;
+
+        const coefficients k = {
+            _mm256_set1_epi32(coefficient_pair(c.y, 4096)), // (y - y_offset) * y + 1 * 4096 (rounding)
+            _mm256_set1_epi32(coefficient_pair(0, c.r_v)),
+            _mm256_set1_epi32(coefficient_pair(c.g_u, c.g_v)),
+            _mm256_set1_epi32(coefficient_pair(c.b_u, 0)),
+        };
+        const __m256i y_offset = _mm256_set1_epi16(c.y_offset);
+        const __m256i chroma_offset = _mm256_set1_epi16(128);
+
+        int x = 0;
+        for (; x + 32 <= width; x += 32)
+        {
+            __m256i r[2];
+            __m256i g[2];
+            __m256i b[2];
+            for (int half = 0; half < 2; ++half)
+            {
+                const int offset = x + 16 * half;
+                const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + offset));
+                __m128i u8;
+                __m128i v8;
+                load_chroma<Src>(u, v, offset, u8, v8);
+
+                convert(_mm256_sub_epi16(_mm256_cvtepu8_epi16(y8), y_offset),
+                        _mm256_sub_epi16(_mm256_cvtepu8_epi16(u8), chroma_offset),
+                        _mm256_sub_epi16(_mm256_cvtepu8_epi16(v8), chroma_offset),
+                        k, r[half], g[half], b[half]);
+            }
+
+            const __m256i r8 = pack(r[0], r[1]);
+            const __m256i g8 = pack(g[0], g[1]);
+            const __m256i b8 = pack(b[0], b[1]);
+            store_pixels<Dst>(dst + x * pixel_size, _mm256_castsi256_si128(r8), _mm256_castsi256_si128(g8), _mm256_castsi256_si128(b8));
+            store_pixels<Dst>(dst + (x + 16) * pixel_size, _mm256_extracti128_si256(r8, 1), _mm256_extracti128_si256(g8, 1), _mm256_extracti128_si256(b8, 1));
+        }
+
+        convert_tail<Src, Dst>(y, u, v, dst, x, width, c);
+    }
+};
+}
+
+namespace detail
+{
+row_function get_avx2_row(yuv_format src_format, rgb_format dst_format)
+{
+    return select_row<avx2_kernel>(src_format, dst_format);
+}
+}
+
+}
+
+#else
+
+namespace tc::vio::simd::detail
+{
+row_function get_avx2_row(yuv_format, rgb_format)
+{
+    return nullptr;
+}
+}
+
+#endif
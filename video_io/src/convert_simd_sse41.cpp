@@ -0,0 +1,119 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Built with SSE4.1 enabled (see CMakeLists.txt): only called after checking the CPU at runtime
+
+#include "convert_simd.hpp"
+
+#if defined(TC_VIO_X86_SIMD)
+#include "convert_simd_x86.hpp"
+
+namespace tc::vio::simd
+{
+namespace
+{
+struct sse41_kernel
+{
+    // 8 pixels, as 16 bit samples without their offsets, to 16 bit channels
+    struct coefficients
+    {
+        __m128i y;
+        __m128i r;
+        __m128i g;
+        __m128i b;
+    };
+
+    static void convert(__m128i y, __m128i u, __m128i v, const coefficients& c, __m128i& r, __m128i& g, __m128i& b)
+    {
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i luma_low = _mm_madd_epi16(_mm_unpacklo_epi16(y, one), c.y);
+        const __m128i luma_high = _mm_madd_epi16(_mm_unpackhi_epi16(y, one), c.y);
+        const __m128i uv_low = _mm_unpacklo_epi16(u, v);
+        const __m128i uv_high = _mm_unpackhi_epi16(u, v);
+
+        auto channel = [&](__m128i coefficients) {
+            const __m128i low = _mm_srai_epi32(_mm_add_epi32(luma_low, _mm_madd_epi16(uv_low, coefficients)), 13);
+            const __m128i high = _mm_srai_epi32(_mm_add_epi32(luma_high, _mm_madd_epi16(uv_high, coefficients)), 13);
+            return _mm_packs_epi32(low, high);
+        };
+
+        r = channel(c.r);
+        g = channel(c.g);
+        b = channel(c.b);
+    }
+
+    template <yuv_format Src, rgb_format Dst>
+    static void row(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width, const yuv_coefficients& c)
+    {
+        constexpr int pixel_size = Dst == rgb_format::rgb24 || Dst == rgb_format::bgr24 ? 3 : 4;
+
+        const coefficients k = {
+            _mm_set1_epi32(coefficient_pair(c.y, 4096)), // (y - y_offset) * y + 1 * 4096 (rounding)
+            _mm_set1_epi32(coefficient_pair(0, c.r_v)),
+            _mm_set1_epi32(coefficient_pair(c.g_u, c.g_v)),
+            _mm_set1_epi32(coefficient_pair(c.b_u, 0)),
+        };
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i y_offset = _mm_set1_epi16(c.y_offset);
+        const __m128i chroma_offset = _mm_set1_epi16(128);
+
+        int x = 0;
+        for (; x + 16 <= width; x += 16)
+        {
+            const __m128i y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+            __m128i u8;
+            __m128i v8;
+            load_chroma<Src>(u, v, x, u8, v8);
+
+            __m128i r[2];
+            __m128i g[2];
+            __m128i b[2];
+            convert(_mm_sub_epi16(_mm_cvtepu8_epi16(y8), y_offset),
+                    _mm_sub_epi16(_mm_cvtepu8_epi16(u8), chroma_offset),
+                    _mm_sub_epi16(_mm_cvtepu8_epi16(v8), chroma_offset),
+                    k, r[0], g[0], b[0]);
+            convert(_mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), y_offset),
+                    _mm_sub_epi16(_mm_unpackhi_epi8(u8, zero), chroma_offset),
+                    _mm_sub_epi16(_mm_unpackhi_epi8(v8, zero), chroma_offset),
+                    k, r[1], g[1], b[1]);
+
+            store_pixels<Dst>(dst + x * pixel_size, _mm_packus_epi16(r[0], r[1]), _mm_packus_epi16(g[0], g[1]), _mm_packus_epi16(b[0], b[1]));
+        }
+
+        convert_tail<Src, Dst>(y, u, v, dst, x, width, c);
+    }
+};
+}
+
+namespace detail
+{
+row_function get_sse41_row(yuv_format src_format, rgb_format dst_format)
+{
+    return select_row<sse41_kernel>(src_format, dst_format);
+}
+}
+
+}
+
+#else
+
+namespace tc::vio::simd::detail
+{
+row_function get_sse41_row(yuv_format, rgb_format)
+{
+    return nullptr;
+}
+}
+
+#endif
@@ -0,0 +1,124 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "convert_simd.hpp"
+
+#include <immintrin.h>
+
+// Helpers shared by the SSE4.1 and AVX2 kernels. Only included by translation units built for a given instruction set:
+// everything is in an anonymous namespace, so that no function compiled for AVX2 can be picked by the linker elsewhere.
+namespace tc::vio::simd
+{
+namespace
+{
+// A 32 bit lane with two 16 bit coefficients, as multiplied by _mm_madd_epi16 with (low, high) sample pairs
+inline int coefficient_pair(int16_t low, int16_t high)
+{
+    return static_cast<int>(static_cast<uint32_t>(static_cast<uint16_t>(high)) << 16 | static_cast<uint16_t>(low));
+}
+
+struct shuffle_mask
+{
+    int8_t bytes[16];
+};
+
+// Bytes of the packed RGB24 output vector (0, 1, 2) taken from the 16 samples of one channel (-128: zero)
+constexpr shuffle_mask rgb24_mask(int vector, int channel)
+{
+    shuffle_mask mask{};
+    for (int i = 0; i < 16; ++i)
+    {
+        const int byte = 16 * vector + i;
+        mask.bytes[i] = static_cast<int8_t>(byte % 3 == channel ? byte / 3 : -128);
+    }
+    return mask;
+}
+
+alignas(16) constexpr shuffle_mask rgb24_masks[3][3] = {
+    {rgb24_mask(0, 0), rgb24_mask(0, 1), rgb24_mask(0, 2)},
+    {rgb24_mask(1, 0), rgb24_mask(1, 1), rgb24_mask(1, 2)},
+    {rgb24_mask(2, 0), rgb24_mask(2, 1), rgb24_mask(2, 2)},
+};
+
+inline __m128i load_mask(const shuffle_mask& mask)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.bytes));
+}
+
+// Store 16 pixels given as one vector per channel
+template <rgb_format Dst>
+inline void store_pixels(uint8_t* dst, __m128i r, __m128i g, __m128i b)
+{
+    constexpr bool is_bgr = Dst == rgb_format::bgr24 || Dst == rgb_format::bgra;
+    const __m128i first = is_bgr ? b : r;
+    const __m128i last = is_bgr ? r : b;
+
+    if constexpr (Dst == rgb_format::rgb24 || Dst == rgb_format::bgr24)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            const __m128i c0 = _mm_shuffle_epi8(first, load_mask(rgb24_masks[i][0]));
+            const __m128i c1 = _mm_shuffle_epi8(g, load_mask(rgb24_masks[i][1]));
+            const __m128i c2 = _mm_shuffle_epi8(last, load_mask(rgb24_masks[i][2]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16 * i), _mm_or_si128(_mm_or_si128(c0, c1), c2));
+        }
+    }
+    else
+    {
+        const __m128i alpha = _mm_set1_epi8(-1);
+        const __m128i first_g_low = _mm_unpacklo_epi8(first, g);
+        const __m128i first_g_high = _mm_unpackhi_epi8(first, g);
+        const __m128i last_a_low = _mm_unpacklo_epi8(last, alpha);
+        const __m128i last_a_high = _mm_unpackhi_epi8(last, alpha);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(first_g_low, last_a_low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(first_g_low, last_a_low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), _mm_unpacklo_epi16(first_g_high, last_a_high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), _mm_unpackhi_epi16(first_g_high, last_a_high));
+    }
+}
+
+// 16 chroma samples (U or V) for 16 pixels, each sample repeated for two adjacent pixels
+template <yuv_format Src>
+inline void load_chroma(const uint8_t* u, const uint8_t* v, int x, __m128i& u8, __m128i& v8)
+{
+    if constexpr (Src == yuv_format::nv12)
+    {
+        const __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x));
+        u8 = _mm_shuffle_epi8(uv, _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14));
+        v8 = _mm_shuffle_epi8(uv, _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15));
+    }
+    else
+    {
+        const __m128i repeat = _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+        u8 = _mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)), repeat);
+        v8 = _mm_shuffle_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)), repeat);
+    }
+}
+
+// Remaining pixels of a row, after the last full vector
+template <yuv_format Src, rgb_format Dst>
+inline void convert_tail(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int x, int width, const yuv_coefficients& c)
+{
+    if (x >= width)
+        return;
+
+    constexpr int pixel_size = Dst == rgb_format::rgb24 || Dst == rgb_format::bgr24 ? 3 : 4;
+    const int u_offset = Src == yuv_format::nv12 ? x : x / 2;
+    const uint8_t* v_row = Src == yuv_format::nv12 ? v : v + x / 2;
+    detail::get_scalar_row(Src, Dst)(y + x, u + u_offset, v_row, dst + x * pixel_size, width - x, c);
+}
+}
+}
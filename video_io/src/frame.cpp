@@ -0,0 +1,195 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/frame.hpp>
+
+#include "logger.hpp"
+#include "pixel_format.hpp"
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <utility>
+
+namespace tc::vio
+{
+frame::frame() noexcept
+    : _frame{av_frame_alloc()}
+    , _pts{-1.0}
+{
+}
+
+frame::~frame() noexcept
+{
+    av_frame_free(&_frame);
+}
+
+frame::frame(frame&& other) noexcept
+    : _frame{std::exchange(other._frame, nullptr)}
+    , _pts{std::exchange(other._pts, -1.0)}
+{
+}
+
+frame& frame::operator=(frame&& other) noexcept
+{
+    if (this != &other)
+    {
+        std::swap(_frame, other._frame);
+        std::swap(_pts, other._pts);
+        other.release();
+    }
+
+    return *this;
+}
+
+bool frame::is_valid() const
+{
+    return _frame && _frame->buf[0] != nullptr;
+}
+
+void frame::release()
+{
+    if (_frame)
+        av_frame_unref(_frame);
+
+    _pts = -1.0;
+}
+
+frame frame::share() const
+{
+    frame f;
+    if (!is_valid())
+        return f;
+
+    if (auto r = av_frame_ref(f._frame, _frame); r < 0)
+    {
+        log_error("av_frame_ref", vio::logger::get().err2str(r));
+        return f;
+    }
+
+    f._pts = _pts;
+    return f;
+}
+
+frame frame::copy() const
+{
+    frame f;
+    if (!is_valid())
+        return f;
+
+    f._frame->format = _frame->format;
+    f._frame->width = _frame->width;
+    f._frame->height = _frame->height;
+    if (auto r = av_frame_get_buffer(f._frame, 0); r < 0)
+    {
+        log_error("av_frame_get_buffer", vio::logger::get().err2str(r));
+        return f;
+    }
+
+    if (auto r = av_frame_copy(f._frame, _frame); r < 0)
+    {
+        log_error("av_frame_copy", vio::logger::get().err2str(r));
+        f.release();
+        return f;
+    }
+
+    av_frame_copy_props(f._frame, _frame);
+    f._pts = _pts;
+    return f;
+}
+
+bool frame::copy_to(uint8_t* buffer, size_t size) const
+{
+    if (!is_valid() || !buffer || size < size_in_bytes())
+        return false;
+
+    if (auto r = av_image_copy_to_buffer(buffer, static_cast<int>(size), _frame->data, _frame->linesize, static_cast<AVPixelFormat>(_frame->format), _frame->width, _frame->height, 1); r < 0)
+    {
+        log_error("av_image_copy_to_buffer", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    return true;
+}
+
+const uint8_t* frame::data(int plane) const
+{
+    if (!is_valid() || plane < 0 || plane >= AV_NUM_DATA_POINTERS)
+        return nullptr;
+
+    return _frame->data[plane];
+}
+
+int frame::linesize(int plane) const
+{
+    if (!is_valid() || plane < 0 || plane >= AV_NUM_DATA_POINTERS)
+        return 0;
+
+    return _frame->linesize[plane];
+}
+
+int frame::planes() const
+{
+    if (!is_valid())
+        return 0;
+
+    const int planes = av_pix_fmt_count_planes(static_cast<AVPixelFormat>(_frame->format));
+    return planes > 0 ? planes : 0;
+}
+
+pixel_format frame::format() const
+{
+    if (!is_valid())
+        return pixel_format::native;
+
+    return from_av_pixel_format(_frame->format);
+}
+
+const char* frame::format_name() const
+{
+    if (!is_valid())
+        return nullptr;
+
+    return av_get_pix_fmt_name(static_cast<AVPixelFormat>(_frame->format));
+}
+
+int frame::width() const
+{
+    return is_valid() ? _frame->width : 0;
+}
+
+int frame::height() const
+{
+    return is_valid() ? _frame->height : 0;
+}
+
+double frame::pts() const
+{
+    return _pts;
+}
+
+size_t frame::size_in_bytes() const
+{
+    if (!is_valid())
+        return 0;
+
+    const int size = av_image_get_buffer_size(static_cast<AVPixelFormat>(_frame->format), _frame->width, _frame->height, 1);
+    return size > 0 ? static_cast<size_t>(size) : 0;
+}
+
+}
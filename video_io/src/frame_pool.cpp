@@ -0,0 +1,220 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/frame_pool.hpp>
+
+#include "logger.hpp"
+#include "pixel_format.hpp"
+
+extern "C"
+{
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+}
+
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+namespace tc::vio
+{
+namespace
+{
+using pool_key = std::tuple<int, int, int, int>; // format, width, height, alignment
+
+std::mutex shared_pools_mutex;
+std::map<pool_key, std::weak_ptr<frame_pool>> shared_pools;
+}
+
+frame_pool::frame_pool(pixel_format format, int width, int height, int alignment) noexcept
+    : frame_pool(static_cast<int>(to_av_pixel_format(format)), width, height, alignment)
+{
+}
+
+frame_pool::frame_pool(int av_pixel_format, int width, int height, int alignment) noexcept
+    : _av_pixel_format{av_pixel_format}
+    , _width{width}
+    , _height{height}
+    , _alignment{alignment}
+    , _linesize{}
+    , _buffer_size{0}
+    , _pool{nullptr}
+    , _allocated_buffers{0}
+{
+    if (alignment <= 0 || !std::has_single_bit(static_cast<unsigned>(alignment)))
+    {
+        log_error("Frame pool alignment must be a power of two:", alignment);
+        return;
+    }
+
+    const auto pix_fmt = static_cast<AVPixelFormat>(av_pixel_format);
+    if (auto r = av_image_fill_linesizes(_linesize, pix_fmt, width); r < 0 || height <= 0)
+    {
+        log_error("Invalid frame pool format or size:", width, "x", height);
+        return;
+    }
+
+    // Every row starts at an aligned address, as required by the SIMD code of swscale
+    ptrdiff_t linesize[4] = {};
+    for (int plane = 0; plane < 4; ++plane)
+    {
+        _linesize[plane] = FFALIGN(_linesize[plane], alignment);
+        linesize[plane] = _linesize[plane];
+    }
+
+    size_t plane_size[4] = {};
+    if (auto r = av_image_fill_plane_sizes(plane_size, pix_fmt, height, linesize); r < 0)
+    {
+        log_error("av_image_fill_plane_sizes", vio::logger::get().err2str(r));
+        return;
+    }
+
+    // The buffer start is aligned up within the allocation
+    _buffer_size = plane_size[0] + plane_size[1] + plane_size[2] + plane_size[3] + alignment - 1;
+
+    if (_pool = av_buffer_pool_init2(_buffer_size, this, &frame_pool::allocate_buffer, nullptr); !_pool)
+        log_error("av_buffer_pool_init2");
+}
+
+frame_pool::~frame_pool() noexcept
+{
+    // The buffers still in use are freed when their last frame is released
+    if (_pool)
+        av_buffer_pool_uninit(&_pool);
+}
+
+std::shared_ptr<frame_pool> frame_pool::get_shared(pixel_format format, int width, int height, int alignment)
+{
+    return get_shared(static_cast<int>(to_av_pixel_format(format)), width, height, alignment);
+}
+
+std::shared_ptr<frame_pool> frame_pool::get_shared(int av_pixel_format, int width, int height, int alignment)
+{
+    std::lock_guard lock(shared_pools_mutex);
+    std::erase_if(shared_pools, [](const auto& item) { return item.second.expired(); });
+
+    auto& shared_pool = shared_pools[{av_pixel_format, width, height, alignment}];
+    auto pool = shared_pool.lock();
+    if (!pool)
+    {
+        pool = std::shared_ptr<frame_pool>(new frame_pool(av_pixel_format, width, height, alignment));
+        shared_pool = pool;
+    }
+
+    return pool;
+}
+
+AVBufferRef* frame_pool::allocate_buffer(void* opaque, size_t size)
+{
+    // Only called by get(), so the pool is alive
+    auto* pool = static_cast<frame_pool*>(opaque);
+    ++pool->_allocated_buffers;
+    return av_buffer_alloc(size);
+}
+
+bool frame_pool::is_valid() const
+{
+    return _pool != nullptr;
+}
+
+bool frame_pool::get(frame& f)
+{
+    if (!f._frame)
+    {
+        if (f._frame = av_frame_alloc(); !f._frame)
+        {
+            log_error("av_frame_alloc");
+            return false;
+        }
+    }
+
+    f._pts = -1.0;
+    if (!get(f._frame))
+    {
+        f.release();
+        return false;
+    }
+
+    return true;
+}
+
+bool frame_pool::get(AVFrame* f)
+{
+    av_frame_unref(f);
+
+    if (!is_valid())
+        return false;
+
+    AVBufferRef* buffer = av_buffer_pool_get(_pool);
+    if (!buffer)
+    {
+        log_error("av_buffer_pool_get");
+        return false;
+    }
+
+    const auto address = reinterpret_cast<uintptr_t>(buffer->data);
+    auto* data = buffer->data + (FFALIGN(address, static_cast<uintptr_t>(_alignment)) - address);
+
+    f->buf[0] = buffer;
+    f->format = _av_pixel_format;
+    f->width = _width;
+    f->height = _height;
+    for (int plane = 0; plane < 4; ++plane)
+        f->linesize[plane] = _linesize[plane];
+
+    if (auto r = av_image_fill_pointers(f->data, static_cast<AVPixelFormat>(_av_pixel_format), _height, data, _linesize); r < 0)
+    {
+        log_error("av_image_fill_pointers", vio::logger::get().err2str(r));
+        av_frame_unref(f);
+        return false;
+    }
+
+    f->extended_data = f->data;
+    return true;
+}
+
+bool frame_pool::matches(int av_pixel_format, int width, int height) const
+{
+    return is_valid() && _av_pixel_format == av_pixel_format && _width == width && _height == height;
+}
+
+int frame_pool::width() const
+{
+    return _width;
+}
+
+int frame_pool::height() const
+{
+    return _height;
+}
+
+int frame_pool::alignment() const
+{
+    return _alignment;
+}
+
+auto frame_pool::get_buffer_size() const -> size_t
+{
+    return _buffer_size;
+}
+
+auto frame_pool::get_high_water_mark() const -> size_t
+{
+    return _allocated_buffers.load();
+}
+
+}
@@ -0,0 +1,197 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/packet.hpp>
+
+#include "logger.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavcodec/codec_par.h>
+#include <libavcodec/packet.h>
+}
+
+// AVPacket::time_base and AVPacket::opaque (used by the whole library, as sws_scale_frame) need FFmpeg 5.0 or later
+#if LIBAVCODEC_VERSION_MAJOR < 59
+#error "FFmpeg 5.0 (libavcodec 59) or later is required"
+#endif
+
+#include <utility>
+
+namespace tc::vio
+{
+namespace
+{
+double to_seconds(int64_t timestamp, AVRational time_base, double missing)
+{
+    if (timestamp == AV_NOPTS_VALUE || time_base.num <= 0 || time_base.den <= 0)
+        return missing;
+
+    return static_cast<double>(timestamp) * av_q2d(time_base);
+}
+}
+
+packet::packet() noexcept
+    : _packet{av_packet_alloc()}
+    , _is_discontinuity{false}
+{
+}
+
+packet::~packet() noexcept
+{
+    av_packet_free(&_packet);
+}
+
+packet::packet(packet&& other) noexcept
+    : _packet{std::exchange(other._packet, nullptr)}
+    , _is_discontinuity{std::exchange(other._is_discontinuity, false)}
+{
+}
+
+packet& packet::operator=(packet&& other) noexcept
+{
+    if (this != &other)
+    {
+        std::swap(_packet, other._packet);
+        std::swap(_is_discontinuity, other._is_discontinuity);
+        other.release();
+    }
+
+    return *this;
+}
+
+bool packet::is_valid() const
+{
+    return _packet && _packet->size > 0;
+}
+
+void packet::release()
+{
+    if (_packet)
+        av_packet_unref(_packet);
+
+    _is_discontinuity = false;
+}
+
+packet packet::share() const
+{
+    packet p;
+    if (!is_valid())
+        return p;
+
+    if (auto r = av_packet_ref(p._packet, _packet); r < 0)
+        log_error("av_packet_ref", vio::logger::get().err2str(r));
+
+    p._is_discontinuity = _is_discontinuity;
+    return p;
+}
+
+const uint8_t* packet::data() const
+{
+    return is_valid() ? _packet->data : nullptr;
+}
+
+size_t packet::size() const
+{
+    return is_valid() ? static_cast<size_t>(_packet->size) : 0;
+}
+
+double packet::pts() const
+{
+    return is_valid() ? to_seconds(_packet->pts, _packet->time_base, -1.0) : -1.0;
+}
+
+double packet::dts() const
+{
+    return is_valid() ? to_seconds(_packet->dts, _packet->time_base, -1.0) : -1.0;
+}
+
+double packet::duration() const
+{
+    return is_valid() ? to_seconds(_packet->duration, _packet->time_base, 0.0) : 0.0;
+}
+
+bool packet::is_keyframe() const
+{
+    return is_valid() && (_packet->flags & AV_PKT_FLAG_KEY);
+}
+
+bool packet::is_discontinuity() const
+{
+    return is_valid() && _is_discontinuity;
+}
+
+codec_parameters::codec_parameters() noexcept
+    : _parameters{avcodec_parameters_alloc()}
+    , _time_base_num{0}
+    , _time_base_den{1}
+{
+}
+
+codec_parameters::~codec_parameters() noexcept
+{
+    avcodec_parameters_free(&_parameters);
+}
+
+codec_parameters::codec_parameters(codec_parameters&& other) noexcept
+    : _parameters{std::exchange(other._parameters, nullptr)}
+    , _time_base_num{std::exchange(other._time_base_num, 0)}
+    , _time_base_den{std::exchange(other._time_base_den, 1)}
+{
+}
+
+codec_parameters& codec_parameters::operator=(codec_parameters&& other) noexcept
+{
+    if (this != &other)
+    {
+        std::swap(_parameters, other._parameters);
+        std::swap(_time_base_num, other._time_base_num);
+        std::swap(_time_base_den, other._time_base_den);
+    }
+
+    return *this;
+}
+
+bool codec_parameters::is_valid() const
+{
+    return _parameters && _parameters->codec_id != AV_CODEC_ID_NONE;
+}
+
+const char* codec_parameters::codec_name() const
+{
+    return is_valid() ? avcodec_get_name(_parameters->codec_id) : nullptr;
+}
+
+int codec_parameters::width() const
+{
+    return is_valid() ? _parameters->width : 0;
+}
+
+int codec_parameters::height() const
+{
+    return is_valid() ? _parameters->height : 0;
+}
+
+const uint8_t* codec_parameters::extradata() const
+{
+    return is_valid() ? _parameters->extradata : nullptr;
+}
+
+size_t codec_parameters::extradata_size() const
+{
+    return is_valid() && _parameters->extradata ? static_cast<size_t>(_parameters->extradata_size) : 0;
+}
+
+}
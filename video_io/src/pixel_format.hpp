@@ -0,0 +1,73 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/frame.hpp>
+
+extern "C"
+{
+#include <libavutil/pixfmt.h>
+}
+
+namespace tc::vio
+{
+inline AVPixelFormat to_av_pixel_format(pixel_format format)
+{
+    switch (format)
+    {
+    case pixel_format::rgb24:
+        return AVPixelFormat::AV_PIX_FMT_RGB24;
+    case pixel_format::bgr24:
+        return AVPixelFormat::AV_PIX_FMT_BGR24;
+    case pixel_format::rgba:
+        return AVPixelFormat::AV_PIX_FMT_RGBA;
+    case pixel_format::bgra:
+        return AVPixelFormat::AV_PIX_FMT_BGRA;
+    case pixel_format::gray8:
+        return AVPixelFormat::AV_PIX_FMT_GRAY8;
+    case pixel_format::nv12:
+        return AVPixelFormat::AV_PIX_FMT_NV12;
+    case pixel_format::yuv420p:
+        return AVPixelFormat::AV_PIX_FMT_YUV420P;
+    case pixel_format::native:
+    default:
+        return AVPixelFormat::AV_PIX_FMT_NONE;
+    }
+}
+
+inline pixel_format from_av_pixel_format(int format)
+{
+    switch (format)
+    {
+    case AVPixelFormat::AV_PIX_FMT_RGB24:
+        return pixel_format::rgb24;
+    case AVPixelFormat::AV_PIX_FMT_BGR24:
+        return pixel_format::bgr24;
+    case AVPixelFormat::AV_PIX_FMT_RGBA:
+        return pixel_format::rgba;
+    case AVPixelFormat::AV_PIX_FMT_BGRA:
+        return pixel_format::bgra;
+    case AVPixelFormat::AV_PIX_FMT_GRAY8:
+        return pixel_format::gray8;
+    case AVPixelFormat::AV_PIX_FMT_NV12:
+        return pixel_format::nv12;
+    case AVPixelFormat::AV_PIX_FMT_YUV420P:
+        return pixel_format::yuv420p;
+    default:
+        return pixel_format::native;
+    }
+}
+
+}
@@ -0,0 +1,393 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/segmented_reader.hpp>
+#include <teiacare/video_io/video_index.hpp>
+
+#include "bounded_queue.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace tc::vio
+{
+namespace
+{
+struct indexed_frame
+{
+    frame f;
+    int index = -1;
+};
+}
+
+struct segmented_reader::frame_queue : bounded_queue<indexed_frame>
+{
+    using bounded_queue::bounded_queue;
+};
+
+struct segmented_reader::segment
+{
+    explicit segment(int64_t start, int64_t end, int first_frame, size_t queue_size)
+        : start{start}
+        , end{end}
+        , first_frame{first_frame}
+        , frames{queue_size}
+    {
+    }
+
+    const int64_t start; // keyframe timestamp (stream time base)
+    const int64_t end;   // start of the next segment
+    const int first_frame;
+    frame_queue frames; // ordered mode only
+    std::atomic<bool> is_failed{false};
+};
+
+segmented_reader::segmented_reader() noexcept
+    : _frame_count{0}
+    , _time_base_num{0}
+    , _time_base_den{1}
+    , _next_segment{0}
+    , _read_segment{0}
+    , _active_workers{0}
+    , _stop{false}
+    , _has_error{false}
+    , _queued_frames{0}
+    , _peak_queued_frames{0}
+{
+}
+
+segmented_reader::~segmented_reader() noexcept
+{
+    release();
+}
+
+bool segmented_reader::open(const char* video_path, decode_support decode_preference, const output_options& output_opt, const segmented_options& segmented_opt)
+{
+    release();
+
+    _options = segmented_opt;
+    _options.min_segment_frames = std::max(1, _options.min_segment_frames);
+    _options.segment_queue_size = std::max(1, _options.segment_queue_size);
+
+    if (!split(video_path))
+    {
+        release();
+        return false;
+    }
+
+    const int available_cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int worker_count = std::min(_options.worker_count > 0 ? _options.worker_count : available_cores, static_cast<int>(_segments.size()));
+
+    // Each worker decodes on a single thread: the parallelism comes from the segments
+    decode_options decode_opt;
+    decode_opt.thread_count = 1;
+
+    for (int i = 0; i < worker_count; ++i)
+    {
+        auto reader = std::make_unique<video_reader>();
+        if (!reader->open(video_path, decode_preference, decode_opt, output_opt))
+        {
+            release();
+            return false;
+        }
+        _readers.push_back(std::move(reader));
+    }
+
+    if (!_options.ordered)
+        _unordered_frames = std::make_unique<frame_queue>(2 * _readers.size());
+
+    _active_workers = _readers.size();
+    for (auto& reader : _readers)
+        _threads.emplace_back(&segmented_reader::worker_loop, this, std::ref(*reader));
+
+    log_info("Segmented reader started, segments:", _segments.size(), "workers:", _readers.size());
+    return true;
+}
+
+bool segmented_reader::split(const char* video_path)
+{
+    // Segment boundaries only need packet timestamps and keyframe flags: no decoding involved
+    video_index index;
+    if (!index.load(video_path) || !index.is_up_to_date(video_path))
+    {
+        log_info("Scanning packets of:", video_path);
+        if (!index.build(video_path))
+            return false;
+    }
+
+    const auto keyframes = index.get_keyframe_timestamps();
+    const auto frame_count = index.get_frame_count();
+    if (keyframes.empty() || !frame_count.has_value())
+    {
+        log_error("No keyframes found in:", video_path);
+        return false;
+    }
+
+    std::tie(_time_base_num, _time_base_den) = index.get_time_base();
+    _frame_count = frame_count.value();
+
+    // Start timestamp and first frame index of every segment
+    std::vector<std::pair<int64_t, int>> boundaries;
+    for (size_t k = 0; k < keyframes.size(); ++k)
+    {
+        const int first_frame = k == 0 ? 0 : index.get_frame_index(keyframes[k]).value_or(_frame_count);
+        if (!boundaries.empty() && first_frame - boundaries.back().second < _options.min_segment_frames)
+            continue;
+
+        boundaries.emplace_back(keyframes[k], first_frame);
+    }
+
+    for (size_t i = 0; i < boundaries.size(); ++i)
+    {
+        const bool is_last = i + 1 == boundaries.size();
+        const int64_t end = is_last ? std::numeric_limits<int64_t>::max() : boundaries[i + 1].first;
+        const int frame_count = (is_last ? _frame_count : boundaries[i + 1].second) - boundaries[i].second;
+
+        // Workers wait for the caller in the middle of a segment once its queue is full
+        const size_t queue_size = _options.ordered ? static_cast<size_t>(std::clamp(frame_count, 1, _options.segment_queue_size)) : 1;
+        _segments.push_back(std::make_unique<segment>(boundaries[i].first, end, boundaries[i].second, queue_size));
+    }
+
+    return true;
+}
+
+bool segmented_reader::is_opened() const
+{
+    return !_readers.empty();
+}
+
+void segmented_reader::release()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _window.notify_all();
+
+    // Wake up the workers waiting for space in a queue
+    for (auto& s : _segments)
+        s->frames.close();
+    if (_unordered_frames)
+        _unordered_frames->close();
+
+    for (auto& t : _threads)
+        t.join();
+
+    _threads.clear();
+    _readers.clear();
+    _segments.clear();
+    _unordered_frames.reset();
+    _frame_count = 0;
+    _next_segment = 0;
+    _read_segment = 0;
+    _active_workers = 0;
+    _stop = false;
+    _has_error = false;
+    _queued_frames = 0;
+    _peak_queued_frames = 0;
+}
+
+void segmented_reader::worker_loop(video_reader& reader)
+{
+    size_t s = 0;
+    while (next_segment(s))
+        decode_segment(reader, *_segments[s]);
+
+    std::lock_guard lock(_mutex);
+    if (--_active_workers == 0 && _unordered_frames)
+        _unordered_frames->close();
+}
+
+bool segmented_reader::next_segment(size_t& s)
+{
+    std::unique_lock lock(_mutex);
+
+    // In ordered mode, workers stay within a window of segments from the one being read, which bounds the queued frames
+    if (_options.ordered)
+    {
+        const size_t window = window_size();
+        _window.wait(lock, [this, window] { return _stop || _next_segment < _read_segment + window; });
+    }
+
+    // Unordered mode: the reads stop at the first failed segment, the remaining ones are not decoded
+    if (_stop || _next_segment >= _segments.size() || (_unordered_frames && _has_error))
+        return false;
+
+    s = _next_segment++;
+    return true;
+}
+
+void segmented_reader::decode_segment(video_reader& reader, segment& s)
+{
+    const double time_base = static_cast<double>(_time_base_num) / static_cast<double>(_time_base_den);
+
+    if (!reader.seek(static_cast<double>(s.start) * time_base, seek_mode::fast))
+    {
+        log_error("Unable to seek to segment starting at frame:", s.first_frame);
+
+        // Its frames would be missing: the reads stop there instead (unordered mode: as soon as the queued frames are read)
+        s.is_failed = true;
+        _has_error = true;
+        s.frames.close();
+        if (_unordered_frames)
+            _unordered_frames->close();
+        return;
+    }
+
+    frame f;
+    int frame_index = s.first_frame;
+    while (reader.read(f))
+    {
+        // Same timeline as the segment boundaries
+        const int64_t timestamp = std::llround(f.pts() / time_base);
+
+        // Leading frames of an open GOP are decoded (correctly) by the worker of the previous segment
+        if (timestamp < s.start && s.first_frame > 0)
+            continue;
+
+        if (timestamp >= s.end)
+            break;
+
+        if (!push(s, std::move(f), frame_index++))
+            break;
+    }
+
+    s.frames.close();
+}
+
+bool segmented_reader::push(segment& s, frame&& f, int frame_index)
+{
+    // Move assignment leaves an empty frame to the worker, ready for the next read
+    indexed_frame item;
+    item.f = std::move(f);
+    item.index = frame_index;
+
+    // Frames waiting for space are counted as well: the peak also includes one frame per worker
+    const size_t queued = ++_queued_frames;
+    size_t peak = _peak_queued_frames.load();
+    while (queued > peak && !_peak_queued_frames.compare_exchange_weak(peak, queued))
+        ;
+
+    auto& frames = _unordered_frames ? *_unordered_frames : s.frames;
+    if (frames.push(std::move(item)))
+        return true;
+
+    --_queued_frames;
+    return false;
+}
+
+size_t segmented_reader::window_size() const
+{
+    return _options.window_segments > 0 ? static_cast<size_t>(_options.window_segments) : 2 * _readers.size();
+}
+
+bool segmented_reader::read(frame& f, int* frame_index)
+{
+    if (frame_index)
+        *frame_index = -1;
+
+    indexed_frame item;
+    if (_unordered_frames)
+    {
+        if (!_unordered_frames->pop(item))
+        {
+            f.release();
+            return false;
+        }
+    }
+    else
+    {
+        // Segments are read one after the other: a segment queue fails to pop once it is closed and empty
+        while (true)
+        {
+            if (_read_segment >= _segments.size())
+            {
+                f.release();
+                return false;
+            }
+
+            if (_segments[_read_segment]->frames.pop(item))
+                break;
+
+            if (_segments[_read_segment]->is_failed)
+            {
+                log_error("Segment starting at frame:", _segments[_read_segment]->first_frame, "could not be decoded");
+                f.release();
+                return false;
+            }
+
+            {
+                std::lock_guard lock(_mutex);
+                ++_read_segment;
+            }
+            _window.notify_all();
+        }
+    }
+
+    --_queued_frames;
+    f = std::move(item.f);
+    if (frame_index)
+        *frame_index = item.index;
+
+    return true;
+}
+
+bool segmented_reader::has_error() const
+{
+    return _has_error;
+}
+
+auto segmented_reader::get_frame_count() const -> std::optional<int>
+{
+    if (!is_opened())
+        return std::nullopt;
+
+    return std::make_optional(_frame_count);
+}
+
+auto segmented_reader::get_frame_size() const -> std::optional<std::tuple<int, int>>
+{
+    if (!is_opened())
+        return std::nullopt;
+
+    return _readers.front()->get_frame_size();
+}
+
+auto segmented_reader::get_fps() const -> std::optional<double>
+{
+    if (!is_opened())
+        return std::nullopt;
+
+    return _readers.front()->get_fps();
+}
+
+auto segmented_reader::get_segment_count() const -> size_t
+{
+    return _segments.size();
+}
+
+auto segmented_reader::get_worker_count() const -> size_t
+{
+    return _readers.size();
+}
+
+auto segmented_reader::get_peak_queued_frames() const -> size_t
+{
+    return _peak_queued_frames.load();
+}
+
+}
@@ -0,0 +1,105 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "slice_pool.hpp"
+
+#include <algorithm>
+
+namespace tc::vio
+{
+slice_pool::slice_pool(int thread_count)
+    : _function{nullptr}
+    , _context{nullptr}
+    , _slice_count{0}
+    , _next_slice{0}
+    , _done_slices{0}
+    , _busy_workers{0}
+    , _stop{false}
+{
+    for (int i = 1; i < std::max(1, thread_count); ++i)
+        _threads.emplace_back(&slice_pool::worker_loop, this);
+}
+
+slice_pool::~slice_pool()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+    }
+    _work_available.notify_all();
+
+    for (auto& t : _threads)
+        t.join();
+}
+
+int slice_pool::get_thread_count() const
+{
+    return static_cast<int>(_threads.size()) + 1;
+}
+
+void slice_pool::run_slices(int slice_count, slice_function function, void* context)
+{
+    std::lock_guard run_lock(_run_mutex);
+
+    std::unique_lock lock(_mutex);
+    _function = function;
+    _context = context;
+    _slice_count = slice_count;
+    _next_slice = 0;
+    _done_slices = 0;
+    _work_available.notify_all();
+
+    process_slices(lock);
+
+    // The job (function and context) must not be used by any worker once run() returns
+    _work_done.wait(lock, [this] { return _done_slices == _slice_count && _busy_workers == 0; });
+    _function = nullptr;
+    _context = nullptr;
+}
+
+void slice_pool::process_slices(std::unique_lock<std::mutex>& lock)
+{
+    while (_next_slice < _slice_count)
+    {
+        const int slice = _next_slice++;
+        const slice_function function = _function;
+        void* context = _context;
+
+        lock.unlock();
+        function(context, slice);
+        lock.lock();
+
+        ++_done_slices;
+    }
+}
+
+void slice_pool::worker_loop()
+{
+    std::unique_lock lock(_mutex);
+    while (true)
+    {
+        _work_available.wait(lock, [this] { return _stop || _next_slice < _slice_count; });
+        if (_stop)
+            return;
+
+        ++_busy_workers;
+        process_slices(lock);
+        --_busy_workers;
+
+        if (_done_slices == _slice_count && _busy_workers == 0)
+            _work_done.notify_one();
+    }
+}
+
+}
@@ -0,0 +1,70 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tc::vio
+{
+// Fork-join pool used to convert a frame in horizontal bands: run() returns once every slice is done.
+// The calling thread processes slices too, so a pool of N threads only starts N - 1 workers.
+// Concurrent run() calls are executed one after the other.
+class slice_pool
+{
+public:
+    explicit slice_pool(int thread_count);
+    ~slice_pool();
+
+    slice_pool(const slice_pool&) = delete;
+    slice_pool& operator=(const slice_pool&) = delete;
+
+    int get_thread_count() const;
+
+    // Call f(slice) for every slice in [0, slice_count), without any allocation
+    template <typename Function>
+    void run(int slice_count, Function&& f)
+    {
+        auto call = [](void* context, int slice) { (*static_cast<std::remove_reference_t<Function>*>(context))(slice); };
+        run_slices(slice_count, call, &f);
+    }
+
+private:
+    using slice_function = void (*)(void* context, int slice);
+
+    void run_slices(int slice_count, slice_function function, void* context);
+    void process_slices(std::unique_lock<std::mutex>& lock);
+    void worker_loop();
+
+    std::mutex _run_mutex; // one run() at a time
+
+    std::mutex _mutex;
+    std::condition_variable _work_available;
+    std::condition_variable _work_done;
+    slice_function _function;
+    void* _context;
+    int _slice_count;
+    int _next_slice;
+    int _done_slices;
+    int _busy_workers;
+    bool _stop;
+
+    std::vector<std::thread> _threads;
+};
+
+}
@@ -0,0 +1,308 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/stream_hint.hpp>
+
+#include "logger.hpp"
+#include "stream_probe.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace tc::vio
+{
+namespace
+{
+constexpr const char* cache_magic = "VIOHINT01";
+constexpr size_t cache_field_count = 12;
+
+struct file_version
+{
+    uint64_t size;
+    int64_t modification_time;
+};
+
+std::optional<file_version> get_file_version(const char* path)
+{
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    const auto modification_time = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return std::nullopt;
+
+    return file_version{size, static_cast<int64_t>(modification_time.time_since_epoch().count())};
+}
+
+// Demuxers have a list of names (e.g. "mov,mp4,m4a,3gp,3g2,mj2"): the first one identifies them
+std::string get_format_name(const AVFormatContext* fmt_ctx)
+{
+    const std::string names = fmt_ctx->iformat ? fmt_ctx->iformat->name : "";
+    return names.substr(0, names.find(','));
+}
+
+template <typename T>
+bool parse(const std::string& text, T& value)
+{
+    const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc{} && end == text.data() + text.size();
+}
+
+std::string to_string(double value)
+{
+    // Shortest representation that reads back to the same value, whatever the locale
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return ec == std::errc{} ? std::string(buffer, end) : "0";
+}
+
+// One line per entry, with tab separated fields: the path is the last one, so that it may contain anything but a line break
+bool parse_entry(const std::string& line, std::string& path, uint64_t& file_size, int64_t& modification_time, stream_hint& hint)
+{
+    std::vector<std::string> fields;
+    size_t begin = 0;
+    while (fields.size() + 1 < cache_field_count)
+    {
+        const size_t end = line.find('\t', begin);
+        if (end == std::string::npos)
+            return false;
+
+        fields.push_back(line.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    path = line.substr(begin);
+
+    hint.format_name = fields[2];
+    hint.codec_name = fields[4];
+    hint.pixel_format_name = fields[5];
+    return !path.empty()
+           && parse(fields[0], file_size)
+           && parse(fields[1], modification_time)
+           && parse(fields[3], hint.stream_index)
+           && parse(fields[6], hint.width)
+           && parse(fields[7], hint.height)
+           && parse(fields[8], hint.frame_rate_num)
+           && parse(fields[9], hint.frame_rate_den)
+           && parse(fields[10], hint.duration);
+}
+}
+
+bool apply_stream_hint(AVFormatContext* fmt_ctx, const stream_hint& hint, bool* is_size_unchecked)
+{
+    if (get_format_name(fmt_ctx) != hint.format_name)
+        return false;
+
+    if (hint.stream_index < 0 || hint.stream_index >= static_cast<int>(fmt_ctx->nb_streams) || hint.width <= 0 || hint.height <= 0)
+        return false;
+
+    AVStream* stream = fmt_ctx->streams[hint.stream_index];
+    AVCodecParameters* codecpar = stream->codecpar;
+    if (codecpar->codec_type != AVMEDIA_TYPE_VIDEO || hint.codec_name != avcodec_get_name(codecpar->codec_id))
+        return false;
+
+    const bool has_header_size = codecpar->width > 0 && codecpar->height > 0;
+    if (!has_header_size && !is_size_unchecked)
+        return false;
+
+    // The parameters already read from the container header must agree with the hint
+    if ((codecpar->width > 0 && codecpar->width != hint.width) || (codecpar->height > 0 && codecpar->height != hint.height))
+        return false;
+
+    const AVPixelFormat pixel_format = av_get_pix_fmt(hint.pixel_format_name.c_str());
+    if (pixel_format == AV_PIX_FMT_NONE || (codecpar->format != AV_PIX_FMT_NONE && codecpar->format != pixel_format))
+        return false;
+
+    codecpar->width = hint.width;
+    codecpar->height = hint.height;
+    codecpar->format = pixel_format;
+    if (is_size_unchecked)
+        *is_size_unchecked = !has_header_size;
+
+    if ((stream->avg_frame_rate.num <= 0 || stream->avg_frame_rate.den <= 0) && hint.frame_rate_num > 0 && hint.frame_rate_den > 0)
+        stream->avg_frame_rate = AVRational{hint.frame_rate_num, hint.frame_rate_den};
+
+    if (stream->r_frame_rate.num <= 0 || stream->r_frame_rate.den <= 0)
+        stream->r_frame_rate = stream->avg_frame_rate;
+
+    // Without probing, the durations are only known when the container header has them
+    if (fmt_ctx->duration == AV_NOPTS_VALUE && hint.duration > 0.0)
+        fmt_ctx->duration = std::llround(hint.duration * AV_TIME_BASE);
+
+    if (stream->duration == AV_NOPTS_VALUE && fmt_ctx->duration != AV_NOPTS_VALUE)
+        stream->duration = av_rescale_q(fmt_ctx->duration, AVRational{1, AV_TIME_BASE}, stream->time_base);
+
+    return true;
+}
+
+auto make_stream_hint(const AVFormatContext* fmt_ctx, int stream_index) -> std::optional<stream_hint>
+{
+    if (stream_index < 0 || stream_index >= static_cast<int>(fmt_ctx->nb_streams))
+        return std::nullopt;
+
+    const AVStream* stream = fmt_ctx->streams[stream_index];
+    const AVCodecParameters* codecpar = stream->codecpar;
+    const char* pixel_format_name = av_get_pix_fmt_name(static_cast<AVPixelFormat>(codecpar->format));
+    if (!pixel_format_name || codecpar->width <= 0 || codecpar->height <= 0)
+        return std::nullopt;
+
+    stream_hint hint;
+    hint.format_name = get_format_name(fmt_ctx);
+    hint.stream_index = stream_index;
+    hint.codec_name = avcodec_get_name(codecpar->codec_id);
+    hint.pixel_format_name = pixel_format_name;
+    hint.width = codecpar->width;
+    hint.height = codecpar->height;
+    hint.frame_rate_num = stream->avg_frame_rate.num;
+    hint.frame_rate_den = stream->avg_frame_rate.den;
+    hint.duration = fmt_ctx->duration != AV_NOPTS_VALUE ? static_cast<double>(fmt_ctx->duration) / AV_TIME_BASE : 0.0;
+    return std::make_optional(hint);
+}
+
+stream_hint_cache::stream_hint_cache() noexcept
+{
+}
+
+stream_hint_cache::~stream_hint_cache() noexcept
+{
+}
+
+auto stream_hint_cache::find(const char* video_path) const -> std::optional<stream_hint>
+{
+    const auto version = get_file_version(video_path);
+    if (!version)
+        return std::nullopt;
+
+    std::lock_guard lock(_mutex);
+    const auto it = _entries.find(video_path);
+    if (it == _entries.end() || it->second.file_size != version->size || it->second.modification_time != version->modification_time)
+        return std::nullopt;
+
+    return std::make_optional(it->second.hint);
+}
+
+bool stream_hint_cache::insert(const char* video_path, const stream_hint& hint)
+{
+    const auto version = get_file_version(video_path);
+    if (!version)
+        return false;
+
+    std::lock_guard lock(_mutex);
+    _entries[video_path] = entry{version->size, version->modification_time, hint};
+    return true;
+}
+
+void stream_hint_cache::erase(const char* video_path)
+{
+    std::lock_guard lock(_mutex);
+    _entries.erase(video_path);
+}
+
+size_t stream_hint_cache::size() const
+{
+    std::lock_guard lock(_mutex);
+    return _entries.size();
+}
+
+void stream_hint_cache::clear()
+{
+    std::lock_guard lock(_mutex);
+    _entries.clear();
+}
+
+bool stream_hint_cache::load(const char* cache_path)
+{
+    std::ifstream file(cache_path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line != cache_magic)
+    {
+        log_error("Invalid stream hint cache:", cache_path);
+        return false;
+    }
+
+    std::unordered_map<std::string, entry> entries;
+    while (std::getline(file, line))
+    {
+        std::string path;
+        entry e = {0, 0, {}};
+        if (!parse_entry(line, path, e.file_size, e.modification_time, e.hint))
+        {
+            log_error("Invalid stream hint cache:", cache_path);
+            return false;
+        }
+
+        entries[path] = e;
+    }
+
+    std::lock_guard lock(_mutex);
+    _entries = std::move(entries);
+    return true;
+}
+
+bool stream_hint_cache::save(const char* cache_path) const
+{
+    // Write a temporary file first, so that a concurrent load() never reads a partial cache
+    const auto tmp_path = std::string(cache_path) + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            log_error("Unable to write stream hint cache:", tmp_path);
+            return false;
+        }
+
+        file << cache_magic << '\n';
+
+        std::lock_guard lock(_mutex);
+        for (const auto& [path, e] : _entries)
+        {
+            const auto& h = e.hint;
+            file << e.file_size << '\t' << e.modification_time << '\t' << h.format_name << '\t' << h.stream_index << '\t'
+                 << h.codec_name << '\t' << h.pixel_format_name << '\t' << h.width << '\t' << h.height << '\t'
+                 << h.frame_rate_num << '\t' << h.frame_rate_den << '\t' << to_string(h.duration) << '\t' << path << '\n';
+        }
+
+        if (!file)
+        {
+            log_error("Unable to write stream hint cache:", tmp_path);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, cache_path, ec);
+    if (ec)
+    {
+        log_error("Unable to write stream hint cache:", cache_path, ec.message());
+        return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,34 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/stream_hint.hpp>
+
+#include <optional>
+
+struct AVFormatContext;
+
+namespace tc::vio
+{
+// Complete the parameters of the streams of an input opened by avformat_open_input() with a hint, instead of probing them:
+// false (and the input left untouched) when the hint does not match the input, which must then be probed.
+// Raw elementary streams (e.g. h264, hevc, mpegvideo) have no frame size in their header to check the hint against:
+// they are only hinted for callers that check the first decoded frame themselves (is_size_unchecked set to true).
+bool apply_stream_hint(AVFormatContext* fmt_ctx, const stream_hint& hint, bool* is_size_unchecked = nullptr);
+
+// Hint of the given stream of a probed input
+auto make_stream_hint(const AVFormatContext* fmt_ctx, int stream_index) -> std::optional<stream_hint>;
+
+}
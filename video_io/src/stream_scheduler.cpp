@@ -0,0 +1,489 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/stream_scheduler.hpp>
+
+#include "logger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <utility>
+
+namespace tc::vio
+{
+struct stream_scheduler::stream
+{
+    int id = -1;
+    stream_options options;
+    std::unique_ptr<video_reader> reader = std::make_unique<video_reader>();
+    frame buffer; // decoded into by the worker running the stream
+
+    // A worker sets is_running before checking is_removed and remove_stream() does the opposite,
+    // so either the worker skips the stream or remove_stream() waits for the end of its turn
+    std::atomic<bool> is_running{false};
+    std::atomic<bool> is_removed{false};
+
+    std::mutex mutex; // frames, dropped_frames, is_blocked and is_end
+    std::condition_variable not_empty;
+    std::deque<frame> frames;
+    uint64_t dropped_frames = 0;
+    bool is_blocked = false; // waiting for the caller to read a frame (overflow_policy::block)
+    bool is_end = false;
+};
+
+struct stream_scheduler::run_queue
+{
+    std::mutex mutex;
+    std::deque<stream_ptr> streams;
+};
+
+stream_scheduler::stream_scheduler() noexcept
+    : _runnable_streams{0}
+    , _next_worker{0}
+    , _next_stream_id{0}
+    , _stop{false}
+{
+}
+
+stream_scheduler::~stream_scheduler() noexcept
+{
+    stop();
+}
+
+bool stream_scheduler::start(const scheduler_options& scheduler_opt)
+{
+    stop();
+
+    _options = scheduler_opt;
+    const int available_cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int worker_count = _options.worker_count > 0 ? _options.worker_count : available_cores;
+
+    _run_queues.clear();
+    for (int i = 0; i < worker_count; ++i)
+        _run_queues.push_back(std::make_unique<run_queue>());
+
+    _stop = false;
+    for (int i = 0; i < worker_count; ++i)
+        _threads.emplace_back(&stream_scheduler::worker_loop, this, static_cast<size_t>(i));
+
+    log_info("Stream scheduler started, workers:", worker_count);
+    return true;
+}
+
+void stream_scheduler::stop()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stop = true;
+
+        // A worker may be blocked in a read that ignores non_blocking (RTSP) or in a reconnection
+        for (auto& [id, s] : _streams)
+            s->reader->interrupt();
+    }
+    _work_available.notify_all();
+
+    for (auto& t : _threads)
+        t.join();
+    _threads.clear();
+
+    std::unordered_map<int, stream_ptr> streams;
+    {
+        std::lock_guard lock(_mutex);
+        std::swap(streams, _streams);
+        _parked_streams.clear();
+        _runnable_streams = 0;
+    }
+
+    // The run queues are kept (empty) until the next start(), in case a read() resumes a blocked stream meanwhile
+    for (auto& q : _run_queues)
+    {
+        std::lock_guard lock(q->mutex);
+        q->streams.clear();
+    }
+
+    // Pending read() calls return once the queued frames are consumed
+    for (auto& [id, s] : streams)
+    {
+        s->reader->release();
+        {
+            std::lock_guard lock(s->mutex);
+            s->is_end = true;
+        }
+        s->not_empty.notify_all();
+    }
+}
+
+bool stream_scheduler::is_running() const
+{
+    return !_threads.empty();
+}
+
+int stream_scheduler::add_stream(const char* video_path, decode_support decode_preference, const output_options& output_opt, const stream_options& stream_opt, const input_options& input_opt)
+{
+    if (!is_running())
+    {
+        log_error("Stream scheduler must be started first");
+        return -1;
+    }
+
+    auto s = std::make_shared<stream>();
+    s->options = stream_opt;
+    s->options.priority = std::max(1, s->options.priority);
+    s->options.queue_capacity = std::max<size_t>(1, s->options.queue_capacity);
+
+    // The workers are the only decoding threads, and a live stream waiting for packets gives its worker back
+    decode_options decode_opt;
+    decode_opt.thread_count = 1;
+    decode_opt.non_blocking = true;
+
+    if (!s->reader->open(video_path, decode_preference, decode_opt, output_opt, input_opt))
+        return -1;
+
+    {
+        std::lock_guard lock(_mutex);
+        s->id = _next_stream_id++;
+        _streams.emplace(s->id, s);
+    }
+
+    const int stream_id = s->id;
+    resume(std::move(s));
+    log_info("Stream scheduled:", stream_id, video_path);
+    return stream_id;
+}
+
+bool stream_scheduler::remove_stream(int stream_id)
+{
+    stream_ptr s;
+    {
+        std::unique_lock lock(_mutex);
+        auto it = _streams.find(stream_id);
+        if (it == _streams.end())
+            return false;
+
+        s = std::move(it->second);
+        _streams.erase(it);
+
+        s->is_removed = true;
+        s->reader->interrupt();
+        _stream_idle.wait(lock, [&s] { return !s->is_running; });
+    }
+
+    // The workers drop the stream the next time it is popped from a run queue
+    s->reader->release();
+    {
+        std::lock_guard lock(s->mutex);
+        s->is_end = true;
+    }
+    s->not_empty.notify_all();
+    return true;
+}
+
+void stream_scheduler::worker_loop(size_t worker)
+{
+    while (true)
+    {
+        {
+            std::lock_guard lock(_mutex);
+            if (_stop)
+                return;
+        }
+
+        if (auto s = pop(worker))
+        {
+            run(worker, s);
+            continue;
+        }
+
+        // Nothing to run: take the live streams whose poll interval has elapsed, or wait for work
+        std::vector<stream_ptr> due_streams;
+        {
+            std::unique_lock lock(_mutex);
+            const auto now = std::chrono::steady_clock::now();
+            while (!_parked_streams.empty() && _parked_streams.begin()->first <= now)
+            {
+                due_streams.push_back(std::move(_parked_streams.begin()->second));
+                _parked_streams.erase(_parked_streams.begin());
+            }
+
+            if (due_streams.empty())
+            {
+                auto has_work = [this] { return _stop || _runnable_streams > 0 || (!_parked_streams.empty() && _parked_streams.begin()->first <= std::chrono::steady_clock::now()); };
+                if (_parked_streams.empty())
+                {
+                    _work_available.wait(lock, has_work);
+                }
+                else
+                {
+                    const auto deadline = _parked_streams.begin()->first;
+                    _work_available.wait_until(lock, deadline, has_work);
+                }
+                continue;
+            }
+        }
+
+        for (auto& s : due_streams)
+            push(worker, std::move(s));
+    }
+}
+
+void stream_scheduler::run(size_t worker, const stream_ptr& s)
+{
+    s->is_running = true;
+
+    // Weighted round robin: a turn lasts up to priority frames
+    bool has_input = true;
+    bool is_queue_full = false;
+    for (int i = 0; i < s->options.priority && !s->is_removed; ++i)
+    {
+        if (!s->options.on_frame && s->options.overflow == overflow_policy::block)
+        {
+            std::lock_guard lock(s->mutex);
+            is_queue_full = s->frames.size() >= s->options.queue_capacity;
+        }
+
+        if (is_queue_full)
+            break;
+
+        if (!s->reader->read(s->buffer))
+        {
+            has_input = false;
+            break;
+        }
+
+        deliver(*s);
+    }
+
+    const bool is_end = !has_input && s->reader->is_end_of_stream();
+
+    {
+        std::lock_guard lock(_mutex);
+        s->is_running = false;
+    }
+    _stream_idle.notify_all();
+
+    if (s->is_removed)
+        return;
+
+    if (is_end)
+    {
+        {
+            std::lock_guard lock(s->mutex);
+            s->is_end = true;
+        }
+        s->not_empty.notify_all();
+        log_info("End of stream:", s->id);
+        return;
+    }
+
+    if (!has_input)
+    {
+        park(s);
+        return;
+    }
+
+    if (is_queue_full)
+    {
+        // Checked again now that the stream is not running: read() resumes it only if it finds it blocked
+        std::lock_guard lock(s->mutex);
+        if (s->frames.size() >= s->options.queue_capacity)
+        {
+            s->is_blocked = true;
+            return;
+        }
+    }
+
+    // Back to the end of the run queue, after the other streams of this worker
+    push(worker, s);
+}
+
+void stream_scheduler::deliver(stream& s)
+{
+    if (s.options.on_frame)
+    {
+        s.options.on_frame(s.id, s.buffer);
+        return;
+    }
+
+    {
+        std::lock_guard lock(s.mutex);
+        if (s.frames.size() >= s.options.queue_capacity)
+        {
+            ++s.dropped_frames;
+
+            // drop_newest: keep the frame buffer for the next decode
+            if (s.options.overflow == overflow_policy::drop_newest)
+                return;
+
+            s.frames.pop_front();
+        }
+
+        // Move assignment leaves an empty frame to decode the next one into
+        s.frames.emplace_back();
+        s.frames.back() = std::move(s.buffer);
+    }
+    s.not_empty.notify_one();
+}
+
+void stream_scheduler::park(stream_ptr s)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _parked_streams.emplace(std::chrono::steady_clock::now() + _options.poll_interval, std::move(s));
+    }
+
+    // An idle worker may be waiting for a later deadline
+    _work_available.notify_one();
+}
+
+void stream_scheduler::resume(stream_ptr s)
+{
+    size_t worker = 0;
+    {
+        std::lock_guard lock(_mutex);
+        if (_stop || _run_queues.empty())
+            return;
+
+        worker = _next_worker++ % _run_queues.size();
+    }
+
+    push(worker, std::move(s));
+}
+
+void stream_scheduler::push(size_t worker, stream_ptr s)
+{
+    {
+        std::lock_guard lock(_run_queues[worker]->mutex);
+        _run_queues[worker]->streams.push_back(std::move(s));
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+        ++_runnable_streams;
+    }
+    _work_available.notify_one();
+}
+
+auto stream_scheduler::pop(size_t worker) -> stream_ptr
+{
+    stream_ptr s;
+
+    // Own run queue first (front), then steal from the other workers (back)
+    for (size_t i = 0; i < _run_queues.size() && !s; ++i)
+    {
+        auto& q = *_run_queues[(worker + i) % _run_queues.size()];
+        std::lock_guard lock(q.mutex);
+        if (q.streams.empty())
+            continue;
+
+        if (i == 0)
+        {
+            s = std::move(q.streams.front());
+            q.streams.pop_front();
+        }
+        else
+        {
+            s = std::move(q.streams.back());
+            q.streams.pop_back();
+        }
+    }
+
+    if (s)
+    {
+        std::lock_guard lock(_mutex);
+        --_runnable_streams;
+    }
+
+    return s;
+}
+
+auto stream_scheduler::find_stream(int stream_id) const -> stream_ptr
+{
+    std::lock_guard lock(_mutex);
+    auto it = _streams.find(stream_id);
+    return it != _streams.end() ? it->second : nullptr;
+}
+
+bool stream_scheduler::take_frame(const stream_ptr& s, frame& f, bool wait)
+{
+    bool is_resumed = false;
+    {
+        std::unique_lock lock(s->mutex);
+        if (wait)
+            s->not_empty.wait(lock, [&s] { return !s->frames.empty() || s->is_end; });
+
+        if (s->frames.empty())
+            return false;
+
+        f = std::move(s->frames.front());
+        s->frames.pop_front();
+        is_resumed = std::exchange(s->is_blocked, false);
+    }
+
+    if (is_resumed)
+        resume(s);
+
+    return true;
+}
+
+bool stream_scheduler::read(int stream_id, frame& f)
+{
+    auto s = find_stream(stream_id);
+    if (!s || !take_frame(s, f, true))
+    {
+        f.release();
+        return false;
+    }
+
+    return true;
+}
+
+bool stream_scheduler::try_read(int stream_id, frame& f)
+{
+    auto s = find_stream(stream_id);
+    return s && take_frame(s, f, false);
+}
+
+bool stream_scheduler::is_end_of_stream(int stream_id) const
+{
+    auto s = find_stream(stream_id);
+    if (!s)
+        return true;
+
+    std::lock_guard lock(s->mutex);
+    return s->is_end && s->frames.empty();
+}
+
+auto stream_scheduler::get_stream_count() const -> size_t
+{
+    std::lock_guard lock(_mutex);
+    return _streams.size();
+}
+
+auto stream_scheduler::get_worker_count() const -> size_t
+{
+    return _threads.size();
+}
+
+auto stream_scheduler::get_dropped_frame_count(int stream_id) const -> uint64_t
+{
+    auto s = find_stream(stream_id);
+    if (!s)
+        return 0;
+
+    std::lock_guard lock(s->mutex);
+    return s->dropped_frames;
+}
+
+}
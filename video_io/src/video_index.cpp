@@ -0,0 +1,515 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <teiacare/video_io/video_index.hpp>
+
+#include "logger.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+}
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+
+namespace tc::vio
+{
+namespace
+{
+constexpr std::array<char, 8> sidecar_magic = {'V', 'I', 'O', 'I', 'D', 'X', '0', '1'};
+constexpr size_t file_prefix_size = 64 * 1024;
+
+// Sidecar entries are stored as deltas from the previous entry, zigzag and varint encoded:
+// consecutive packets have close timestamps and offsets, so most fields take one or two bytes.
+uint64_t zigzag_encode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t zigzag_decode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Deltas wrap around instead of overflowing: AV_NOPTS_VALUE next to a regular timestamp takes ten bytes, and reads back exactly
+int64_t get_delta(int64_t value, int64_t previous)
+{
+    return static_cast<int64_t>(static_cast<uint64_t>(value) - static_cast<uint64_t>(previous));
+}
+
+int64_t apply_delta(int64_t previous, uint64_t encoded_delta)
+{
+    return static_cast<int64_t>(static_cast<uint64_t>(previous) + static_cast<uint64_t>(zigzag_decode(encoded_delta)));
+}
+
+void write_varint(std::ostream& os, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        os.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    os.put(static_cast<char>(value));
+}
+
+bool read_varint(std::istream& is, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        const int byte = is.get();
+        if (byte == std::char_traits<char>::eof())
+            return false;
+
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// FNV-1a hash of the first bytes of the file: it does not change when a file is only appended to
+std::optional<uint64_t> get_file_prefix_hash(const char* path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return std::nullopt;
+
+    std::vector<char> prefix(file_prefix_size);
+    file.read(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (std::streamsize i = 0; i < file.gcount(); ++i)
+    {
+        hash ^= static_cast<uint8_t>(prefix[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+int64_t get_presentation_timestamp(const index_entry& e)
+{
+    return e.pts != AV_NOPTS_VALUE ? e.pts : e.dts;
+}
+}
+
+video_index::video_index() noexcept
+{
+    clear();
+}
+
+video_index::~video_index() noexcept
+{
+}
+
+void video_index::clear()
+{
+    _entries.clear();
+    _sorted_pts.clear();
+    _keyframes.clear();
+    _stream_index = -1;
+    _time_base_num = 0;
+    _time_base_den = 1;
+    _file_size = 0;
+    _file_prefix_hash = 0;
+}
+
+std::string video_index::get_sidecar_path(const char* video_path)
+{
+    return std::string(video_path) + ".vioidx";
+}
+
+bool video_index::build(const char* video_path)
+{
+    std::error_code ec;
+    const uint64_t file_size = std::filesystem::file_size(video_path, ec);
+    const auto prefix_hash = get_file_prefix_hash(video_path);
+    if (ec || !prefix_hash)
+    {
+        log_error("Unable to read video path:", video_path);
+        return false;
+    }
+
+    // The file has only grown since the last build if its first bytes did not change
+    bool resume = !_entries.empty() && *prefix_hash == _file_prefix_hash && file_size >= _file_size;
+    if (resume && file_size == _file_size)
+        return true;
+
+    if (!resume)
+        clear();
+
+    AVFormatContext* fmt_ctx = nullptr;
+    if (fmt_ctx = avformat_alloc_context(); !fmt_ctx)
+    {
+        log_error("avformat_alloc_context");
+        return false;
+    }
+
+    if (auto r = avformat_open_input(&fmt_ctx, video_path, nullptr, nullptr); r < 0)
+    {
+        log_error("avformat_open_input", vio::logger::get().err2str(r));
+        reset(fmt_ctx);
+        return false;
+    }
+
+    if (auto r = avformat_find_stream_info(fmt_ctx, nullptr); r < 0)
+    {
+        log_error("avformat_find_stream_info", vio::logger::get().err2str(r));
+        reset(fmt_ctx);
+        return false;
+    }
+
+    // Same stream selection as video_reader
+    const int stream_index = av_find_best_stream(fmt_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (stream_index < 0)
+    {
+        log_error("av_find_best_stream", vio::logger::get().err2str(stream_index));
+        reset(fmt_ctx);
+        return false;
+    }
+
+    const AVRational time_base = fmt_ctx->streams[stream_index]->time_base;
+    if (resume && (stream_index != _stream_index || time_base.num != _time_base_num || time_base.den != _time_base_den))
+    {
+        resume = false;
+        clear();
+    }
+
+    // Rescan from the last indexed keyframe: the packets after it may have been incomplete when the file was indexed
+    int64_t resume_dts = AV_NOPTS_VALUE;
+    if (resume)
+    {
+        const auto keyframe = std::find_if(_entries.rbegin(), _entries.rend(), [](const index_entry& e) { return e.keyframe && e.dts != AV_NOPTS_VALUE; });
+        if (keyframe == _entries.rend() || av_seek_frame(fmt_ctx, stream_index, get_presentation_timestamp(*keyframe), AVSEEK_FLAG_BACKWARD) < 0)
+        {
+            clear();
+        }
+        else
+        {
+            resume_dts = keyframe->dts;
+            _entries.erase(std::prev(keyframe.base()), _entries.end());
+        }
+    }
+
+    _stream_index = stream_index;
+    _time_base_num = time_base.num;
+    _time_base_den = time_base.den;
+
+    for (unsigned int i = 0; i < fmt_ctx->nb_streams; ++i)
+    {
+        if (static_cast<int>(i) != stream_index)
+            fmt_ctx->streams[i]->discard = AVDISCARD_ALL;
+    }
+
+    const bool scanned = scan(fmt_ctx, resume_dts);
+    reset(fmt_ctx);
+
+    if (!scanned)
+    {
+        if (resume_dts == AV_NOPTS_VALUE)
+            return false;
+
+        log_info("Unable to resume the video index, indexing the whole file:", video_path);
+        clear();
+        return build(video_path);
+    }
+
+    _file_size = file_size;
+    _file_prefix_hash = *prefix_hash;
+    update_lookup_tables();
+
+    log_info("Video index:", _entries.size(), "packets,", _keyframes.size(), "keyframes");
+    return true;
+}
+
+bool video_index::scan(AVFormatContext* fmt_ctx, int64_t resume_dts)
+{
+    AVPacket* packet = nullptr;
+    if (packet = av_packet_alloc(); !packet)
+    {
+        log_error("av_packet_alloc");
+        return false;
+    }
+
+    bool is_first_packet = true;
+    while (true)
+    {
+        const int r = av_read_frame(fmt_ctx, packet);
+        if (r == AVERROR(EAGAIN))
+            continue;
+
+        if (r < 0)
+        {
+            // A recording in progress usually ends with an incomplete packet: index up to the last complete one
+            if (r != AVERROR_EOF)
+                log_info("av_read_frame", vio::logger::get().err2str(r));
+            break;
+        }
+
+        if (packet->stream_index != _stream_index)
+        {
+            av_packet_unref(packet);
+            continue;
+        }
+
+        if (resume_dts != AV_NOPTS_VALUE && packet->dts != AV_NOPTS_VALUE)
+        {
+            // The seek must land at or before the keyframe the index is resumed from, otherwise packets would be missing
+            if (is_first_packet && packet->dts > resume_dts)
+            {
+                av_packet_free(&packet);
+                return false;
+            }
+
+            if (packet->dts < resume_dts)
+            {
+                is_first_packet = false;
+                av_packet_unref(packet);
+                continue;
+            }
+        }
+
+        is_first_packet = false;
+        _entries.push_back({packet->pts, packet->dts, packet->pos, packet->size, (packet->flags & AV_PKT_FLAG_KEY) != 0});
+        av_packet_unref(packet);
+    }
+
+    av_packet_free(&packet);
+    return true;
+}
+
+bool video_index::load(const char* video_path)
+{
+    clear();
+
+    const auto sidecar_path = get_sidecar_path(video_path);
+    std::ifstream file(sidecar_path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::array<char, sidecar_magic.size()> magic = {};
+    file.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+    if (!file || magic != sidecar_magic)
+    {
+        log_error("Invalid video index:", sidecar_path);
+        return false;
+    }
+
+    uint64_t stream_index = 0, time_base_num = 0, time_base_den = 0, file_size = 0, file_prefix_hash = 0, count = 0;
+    bool ok = read_varint(file, stream_index) && read_varint(file, time_base_num) && read_varint(file, time_base_den)
+              && read_varint(file, file_size) && read_varint(file, file_prefix_hash) && read_varint(file, count);
+
+    index_entry previous = {0, 0, 0, 0, false};
+    for (uint64_t i = 0; ok && i < count; ++i)
+    {
+        uint64_t pts = 0, dts = 0, pos = 0, size = 0;
+        ok = read_varint(file, pts) && read_varint(file, dts) && read_varint(file, pos) && read_varint(file, size);
+        const int flags = file.get();
+        if (!ok || flags == std::char_traits<char>::eof())
+        {
+            ok = false;
+            break;
+        }
+
+        const index_entry e = {
+            apply_delta(previous.pts, pts),
+            apply_delta(previous.dts, dts),
+            apply_delta(previous.pos, pos),
+            static_cast<int>(size),
+            (flags & 1) != 0,
+        };
+        _entries.push_back(e);
+        previous = e;
+    }
+
+    if (!ok)
+    {
+        log_error("Invalid video index:", sidecar_path);
+        clear();
+        return false;
+    }
+
+    _stream_index = static_cast<int>(stream_index);
+    _time_base_num = static_cast<int>(time_base_num);
+    _time_base_den = static_cast<int>(time_base_den);
+    _file_size = file_size;
+    _file_prefix_hash = file_prefix_hash;
+    update_lookup_tables();
+    return true;
+}
+
+bool video_index::save(const char* video_path) const
+{
+    if (_entries.empty())
+    {
+        log_error("Unable to save an empty video index");
+        return false;
+    }
+
+    // Write a temporary file first, so that a concurrent open() never loads a partial index
+    const auto sidecar_path = get_sidecar_path(video_path);
+    const auto tmp_path = sidecar_path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            log_error("Unable to write video index:", tmp_path);
+            return false;
+        }
+
+        file.write(sidecar_magic.data(), static_cast<std::streamsize>(sidecar_magic.size()));
+        write_varint(file, static_cast<uint64_t>(_stream_index));
+        write_varint(file, static_cast<uint64_t>(_time_base_num));
+        write_varint(file, static_cast<uint64_t>(_time_base_den));
+        write_varint(file, _file_size);
+        write_varint(file, _file_prefix_hash);
+        write_varint(file, _entries.size());
+
+        index_entry previous = {0, 0, 0, 0, false};
+        for (const auto& e : _entries)
+        {
+            write_varint(file, zigzag_encode(get_delta(e.pts, previous.pts)));
+            write_varint(file, zigzag_encode(get_delta(e.dts, previous.dts)));
+            write_varint(file, zigzag_encode(get_delta(e.pos, previous.pos)));
+            write_varint(file, static_cast<uint64_t>(e.size));
+            file.put(e.keyframe ? 1 : 0);
+            previous = e;
+        }
+
+        if (!file)
+        {
+            log_error("Unable to write video index:", tmp_path);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, sidecar_path, ec);
+    if (ec)
+    {
+        log_error("Unable to write video index:", sidecar_path, ec.message());
+        return false;
+    }
+
+    return true;
+}
+
+bool video_index::is_up_to_date(const char* video_path) const
+{
+    if (_entries.empty())
+        return false;
+
+    std::error_code ec;
+    const uint64_t file_size = std::filesystem::file_size(video_path, ec);
+    if (ec || file_size != _file_size)
+        return false;
+
+    const auto prefix_hash = get_file_prefix_hash(video_path);
+    return prefix_hash && *prefix_hash == _file_prefix_hash;
+}
+
+auto video_index::get_entries() const -> const std::vector<index_entry>&
+{
+    return _entries;
+}
+
+auto video_index::get_frame_count() const -> std::optional<int>
+{
+    if (_entries.empty())
+        return std::nullopt;
+
+    return std::make_optional(static_cast<int>(_entries.size()));
+}
+
+auto video_index::get_stream_index() const -> int
+{
+    return _stream_index;
+}
+
+auto video_index::get_time_base() const -> std::tuple<int, int>
+{
+    return std::make_tuple(_time_base_num, _time_base_den);
+}
+
+auto video_index::find_keyframe(int64_t timestamp) const -> std::optional<index_entry>
+{
+    auto it = std::upper_bound(_keyframes.begin(), _keyframes.end(), timestamp, [this](int64_t ts, size_t i) { return ts < get_presentation_timestamp(_entries[i]); });
+    if (it == _keyframes.begin())
+        return std::nullopt;
+
+    return std::make_optional(_entries[*std::prev(it)]);
+}
+
+auto video_index::get_frame_timestamp(int frame_index) const -> std::optional<int64_t>
+{
+    if (frame_index < 0 || static_cast<size_t>(frame_index) >= _sorted_pts.size())
+        return std::nullopt;
+
+    return std::make_optional(_sorted_pts[frame_index]);
+}
+
+auto video_index::get_frame_index(int64_t timestamp) const -> std::optional<int>
+{
+    auto it = std::lower_bound(_sorted_pts.begin(), _sorted_pts.end(), timestamp);
+    if (it == _sorted_pts.end())
+        return std::nullopt;
+
+    return std::make_optional(static_cast<int>(std::distance(_sorted_pts.begin(), it)));
+}
+
+auto video_index::get_keyframe_timestamps() const -> std::vector<int64_t>
+{
+    std::vector<int64_t> timestamps;
+    timestamps.reserve(_keyframes.size());
+    for (size_t i : _keyframes)
+        timestamps.push_back(get_presentation_timestamp(_entries[i]));
+
+    return timestamps;
+}
+
+void video_index::update_lookup_tables()
+{
+    // Packets are stored in decode order: build the presentation order views used by seeks
+    _sorted_pts.clear();
+    _keyframes.clear();
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        const int64_t pts = get_presentation_timestamp(_entries[i]);
+        if (pts == AV_NOPTS_VALUE)
+            continue;
+
+        _sorted_pts.push_back(pts);
+        if (_entries[i].keyframe)
+            _keyframes.push_back(i);
+    }
+
+    std::sort(_sorted_pts.begin(), _sorted_pts.end());
+    std::stable_sort(_keyframes.begin(), _keyframes.end(), [this](size_t a, size_t b) { return get_presentation_timestamp(_entries[a]) < get_presentation_timestamp(_entries[b]); });
+}
+
+void video_index::reset(AVFormatContext* fmt_ctx)
+{
+    if (fmt_ctx)
+    {
+        avformat_close_input(&fmt_ctx);
+        avformat_free_context(fmt_ctx);
+    }
+}
+
+}
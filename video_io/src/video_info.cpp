@@ -15,6 +15,7 @@
 #include <teiacare/video_io/video_info.hpp>
 
 #include "logger.hpp"
+#include "stream_probe.hpp"
 
 extern "C"
 {
@@ -33,7 +34,7 @@ video_info::~video_info() noexcept
 {
 }
 
-std::optional<video_metadata> video_info::get_video_metadata(const std::string& video_path)
+std::optional<video_metadata> video_info::get_video_metadata(const std::string& video_path, const std::shared_ptr<stream_hint_cache>& hint_cache)
 {
     AVFormatContext* fmt_ctx;
 
@@ -51,15 +52,20 @@ std::optional<video_metadata> video_info::get_video_metadata(const std::string&
         return std::nullopt;
     }
 
-    if (auto r = avformat_find_stream_info(fmt_ctx, nullptr); r < 0)
+    const auto hint = hint_cache ? hint_cache->find(video_path.c_str()) : std::nullopt;
+    const bool is_hinted = hint && apply_stream_hint(fmt_ctx, *hint);
+    if (!is_hinted)
     {
-        log_error("avformat_find_stream_info", vio::logger::get().err2str(r));
-        reset(fmt_ctx);
-        return std::nullopt;
+        if (auto r = avformat_find_stream_info(fmt_ctx, nullptr); r < 0)
+        {
+            log_error("avformat_find_stream_info", vio::logger::get().err2str(r));
+            reset(fmt_ctx);
+            return std::nullopt;
+        }
     }
 
     const AVCodec* codec = nullptr;
-    int stream_index = av_find_best_stream(fmt_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    int stream_index = av_find_best_stream(fmt_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, is_hinted ? hint->stream_index : -1, -1, &codec, 0);
     if (stream_index < 0)
     {
         log_error("av_find_best_stream", vio::logger::get().err2str(stream_index));
@@ -67,6 +73,12 @@ std::optional<video_metadata> video_info::get_video_metadata(const std::string&
         return std::nullopt;
     }
 
+    if (!is_hinted && hint_cache)
+    {
+        if (const auto probed_hint = make_stream_hint(fmt_ctx, stream_index); probed_hint)
+            hint_cache->insert(video_path.c_str(), *probed_hint);
+    }
+
     AVStream* stream = fmt_ctx->streams[stream_index];
     const auto m = video_metadata{
         stream->id,
@@ -12,26 +12,54 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <teiacare/video_io/frame_pool.hpp>
+#include <teiacare/video_io/video_index.hpp>
 #include <teiacare/video_io/video_reader.hpp>
 
+#include "convert_simd.hpp"
 #include "logger.hpp"
+#include "pixel_format.hpp"
+#include "slice_pool.hpp"
+#include "stream_probe.hpp"
 #include "video_reader_hw.hpp"
+#include "video_reader_io.hpp"
+#include "video_reader_pipeline.hpp"
 
 extern "C"
 {
 #include <libavcodec/avcodec.h>
+#include <libavcodec/bsf.h>
 #include <libavformat/avformat.h>
 #include <libavutil/buffer.h>
 #include <libavutil/dict.h>
 #include <libavutil/frame.h>
 #include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
     // #include <libavdevice/avdevice.h> // required for screen recording only
 }
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace tc::vio
 {
 video_reader::video_reader() noexcept
+    : _sws_ctx{nullptr}
+    , _packet{nullptr}
+    , _src_frame{nullptr}
+    , _dst_frame{nullptr}
+    , _hw_frame{nullptr}
+    , _ready_frame{nullptr}
+    , _io{std::make_unique<io_control>()}
 {
     init();
     av_log_set_level(0);
@@ -41,31 +69,55 @@ video_reader::video_reader() noexcept
 video_reader::~video_reader() noexcept
 {
     release();
+
+    if (_sws_ctx)
+        sws_freeContext(_sws_ctx);
+
+    av_packet_free(&_packet);
+    av_frame_free(&_src_frame);
+    av_frame_free(&_dst_frame);
+    av_frame_free(&_hw_frame);
+    av_frame_free(&_ready_frame);
 }
 
 void video_reader::init()
 {
     log_info("Reset video capture");
 
+    // The packet, the frames and the SwsContext are kept (empty) across release() and open()
     _format_ctx = nullptr;
     _codec_ctx = nullptr;
-    _sws_ctx = nullptr;
-    _packet = nullptr;
-
-    _src_frame = nullptr;
+    _bsf_ctx = nullptr;
     _tmp_frame = nullptr;
-    _dst_frame = nullptr;
 
     _decode_support = decode_support::none;
+    _input_options = {};
+    _decode_options = {};
+    _output_options = {};
+    _output_width = 0;
+    _output_height = 0;
     _options = nullptr;
+    _input_path.clear();
     _stream_index = -1;
+    _stream_properties = {};
+    _has_pending_frame = false;
+    _is_waiting_for_input = false;
+    _is_end_of_stream = false;
+    _is_probed = false;
+    _is_hint_rejected = false;
+    _decoded_frame_count = 0;
+    _select_interval = 0;
+    _next_select_timestamp = AV_NOPTS_VALUE;
 }
 
 // void video_reader::set_log_callback(const log_callback_t& cb, const log_level& level) { vio::logger::get().set_log_callback(cb, level); }
 
-bool video_reader::open(const char* video_path, decode_support decode_preference)
+bool video_reader::open(const char* video_path, decode_support decode_preference, const decode_options& decode_opt, const output_options& output_opt, const input_options& input_opt)
 {
     release();
+    _input_options = input_opt;
+    _decode_options = decode_opt;
+    _output_options = output_opt;
 
     log_info("Opening video path:", video_path);
     log_info("HW acceleration", (decode_preference == decode_support::HW ? "required" : "not required"));
@@ -86,13 +138,38 @@ bool video_reader::open(const char* video_path, decode_support decode_preference
         return false;
     }
 
-    if (auto r = av_dict_set(&_options, "rtsp_transport", "tcp", 0); r < 0)
-    {
-        log_error("av_dict_set", vio::logger::get().err2str(r));
+    _input_path = video_path;
+    _io->attach(_format_ctx);
+
+    if (!setup_input_options())
         return false;
+
+    // Files already probed by a previous open() are not probed again
+    if (!_input_options.hint && _input_options.hint_cache)
+        _input_options.hint = _input_options.hint_cache->find(video_path);
+
+    if (!open_input(video_path, nullptr))
+    {
+        if (!_is_hint_rejected)
+            return false;
+
+        // Open again from scratch, without the hint (nor its cache entry)
+        if (input_opt.hint_cache)
+            input_opt.hint_cache->erase(video_path);
+
+        auto probed_input_opt = input_opt;
+        probed_input_opt.hint.reset();
+        return open(video_path, decode_preference, decode_opt, output_opt, probed_input_opt);
+    }
+
+    if (_is_probed && _input_options.hint_cache)
+    {
+        if (const auto hint = get_stream_hint(); hint)
+            _input_options.hint_cache->insert(video_path, *hint);
     }
 
-    return open_input(video_path, nullptr);
+    load_index(video_path);
+    return true;
 }
 
 bool video_reader::open(const char* screen_name, screen_options screen_opt)
@@ -109,6 +186,8 @@ bool video_reader::open(const char* screen_name, screen_options screen_opt)
         return false;
     }
 
+    _io->attach(_format_ctx);
+
     const AVInputFormat* input_format = nullptr;
     screen_name = nullptr;
 
@@ -160,41 +239,99 @@ bool video_reader::open(const char* screen_name, screen_options screen_opt)
     return open_input(screen_name, input_format);
 }
 
+bool video_reader::setup_input_options()
+{
+    // Each demuxer only applies the options it knows (e.g. a file ignores the RTSP ones)
+    std::vector<std::pair<const char*, std::string>> options = {{"rtsp_transport", _input_options.transport == rtsp_transport::udp ? "udp" : "tcp"}};
+
+    if (_input_options.probe_size > 0)
+        options.emplace_back("probesize", std::to_string(_input_options.probe_size));
+
+    if (_input_options.analyze_duration > 0)
+        options.emplace_back("analyzeduration", std::to_string(_input_options.analyze_duration));
+
+    std::string flags;
+    if (_input_options.no_buffer)
+        flags += "+nobuffer";
+    if (_input_options.discard_corrupt)
+        flags += "+discardcorrupt";
+    if (!flags.empty())
+        options.emplace_back("fflags", flags);
+
+    if (_input_options.max_delay >= 0)
+        options.emplace_back("max_delay", std::to_string(_input_options.max_delay));
+
+    if (_input_options.reorder_queue_size >= 0)
+        options.emplace_back("reorder_queue_size", std::to_string(_input_options.reorder_queue_size));
+
+    if (_input_options.rtsp_listen)
+        options.emplace_back("rtsp_flags", "listen");
+
+    for (const auto& [key, value] : options)
+    {
+        if (auto r = av_dict_set(&_options, key, value.c_str(), 0); r < 0)
+        {
+            log_error("av_dict_set", key, vio::logger::get().err2str(r));
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool video_reader::open_input(const char* input, const AVInputFormat* input_format)
 {
+    // Connecting and probing share the same deadline
+    _io->set_deadline(_input_options.open_timeout);
+
     if (auto r = avformat_open_input(&_format_ctx, input, input_format, &_options); r < 0)
     {
-        log_error("avformat_open_input", vio::logger::get().err2str(r));
+        _io->clear_deadline();
+        log_error("avformat_open_input", _io->is_timed_out() ? "timed out" : vio::logger::get().err2str(r));
         return false;
     }
 
     av_dict_free(&_options);
 
-    if (auto r = avformat_find_stream_info(_format_ctx, nullptr); r < 0)
+    // With a hint matching the input, the streams are not probed by decoding their first frames
+    bool is_size_unchecked = false;
+    const bool is_hinted = _input_options.hint && apply_stream_hint(_format_ctx, *_input_options.hint, &is_size_unchecked);
+    if (_input_options.hint && !is_hinted)
+        log_info("Stream hint does not match the input: probing it");
+
+    if (!is_hinted)
     {
-        log_error("avformat_find_stream_info");
-        return false;
+        if (auto r = avformat_find_stream_info(_format_ctx, nullptr); r < 0)
+        {
+            _io->clear_deadline();
+            log_error("avformat_find_stream_info", _io->is_timed_out() ? "timed out" : vio::logger::get().err2str(r));
+            return false;
+        }
+
+        _is_probed = true;
     }
 
-/* NOTE: this is a breaking change from ffmpeg v4.x to ffmpeg v5.x in function av_find_best_stream */
-#if LIBAVCODEC_VERSION_MAJOR <= 58
-    const AVCodec* codec = nullptr;
-#elif LIBAVCODEC_VERSION_MAJOR >= 59
+    _io->clear_deadline();
+
     const AVCodec* codec = nullptr;
-#endif
 
-    if (_stream_index = av_find_best_stream(_format_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0); _stream_index < 0)
+    const int wanted_stream_index = is_hinted ? _input_options.hint->stream_index : -1;
+    if (_stream_index = av_find_best_stream(_format_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, wanted_stream_index, -1, &codec, 0); _stream_index < 0)
     {
         log_error("av_find_best_stream", vio::logger::get().err2str(_stream_index));
         return false;
     }
 
+    setup_demuxer();
+
+    const AVStream* stream = _format_ctx->streams[_stream_index];
+    _stream_properties = {stream->time_base.num, stream->time_base.den, stream->avg_frame_rate.num, stream->avg_frame_rate.den, stream->start_time, stream->nb_frames, _format_ctx->duration};
+
     if (_codec_ctx = avcodec_alloc_context3(codec); !_codec_ctx)
     {
         log_error("avcodec_alloc_context3");
         return false;
     }
-    _codec_ctx->thread_count = 1; // std::thread::hardware_concurrency();
 
     if (auto r = avcodec_parameters_to_context(_codec_ctx, _format_ctx->streams[_stream_index]->codecpar); r < 0)
     {
@@ -202,6 +339,14 @@ bool video_reader::open_input(const char* input, const AVInputFormat* input_form
         return false;
     }
 
+    if (!setup_bitstream_filter())
+        return false;
+
+    if (_input_options.low_delay)
+        _codec_ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+
+    setup_threading(codec);
+
     if (_decode_support == decode_support::HW)
     {
         // _codec_ctx->sw_pix_fmt = AV_PIX_FMT_NV12;
@@ -209,332 +354,1742 @@ bool video_reader::open_input(const char* input, const AVInputFormat* input_form
         // _codec_ctx->hw_frames_ctx = _hw->get_frames_ctx(_codec_ctx->width, _codec_ctx->height);
     }
 
+    setup_lowres(codec);
+
+    if (_decode_options.keyframes_only)
+        _codec_ctx->skip_frame = AVDISCARD_NONKEY;
+
     if (auto r = avcodec_open2(_codec_ctx, codec, nullptr); r < 0)
     {
         log_error("avcodec_open2", vio::logger::get().err2str(r));
         return false;
     }
 
-    if (_packet = av_packet_alloc(); !_packet)
+    setup_output_size();
+    setup_subsampling();
+    setup_frame_pool();
+
+    if (!_packet)
     {
-        log_error("av_packet_alloc");
-        return false;
+        if (_packet = av_packet_alloc(); !_packet)
+        {
+            log_error("av_packet_alloc");
+            return false;
+        }
     }
 
-    if (_src_frame = av_frame_alloc(); !_src_frame)
+    if (!_src_frame)
     {
-        log_error("av_frame_alloc");
-        return false;
+        if (_src_frame = av_frame_alloc(); !_src_frame)
+        {
+            log_error("av_frame_alloc");
+            return false;
+        }
     }
 
-    if (_dst_frame = av_frame_alloc(); !_dst_frame)
+    if (!_dst_frame)
     {
-        log_error("av_frame_alloc");
-        return false;
+        if (_dst_frame = av_frame_alloc(); !_dst_frame)
+        {
+            log_error("av_frame_alloc");
+            return false;
+        }
     }
 
-    if (_decode_support == decode_support::HW)
+    if (_decode_support == decode_support::HW && !_hw_frame)
     {
-        // HW: Allocate one extra frame for HW decoding.
-        if (_tmp_frame = av_frame_alloc(); !_tmp_frame)
+        // HW: Allocate one extra frame to download the decoded frames to.
+        if (_hw_frame = av_frame_alloc(); !_hw_frame)
         {
             log_error("av_frame_alloc");
             return false;
         }
     }
-    else
+
+    // SW: No need of any temporary frame, just make it point to _src_frame.
+    _tmp_frame = _src_frame;
+
+    // Start of the idle_timeout, before the demuxing thread reads the first packet
+    _io->packet_received();
+
+    // Without a frame size in the input header, the hint is checked against the first frame, before any other thread decodes
+    if (is_size_unchecked && !check_first_frame())
     {
-        // SW: No need to allocate any temporary frame, just make it point to _src_frame.
-        _tmp_frame = _src_frame;
+        log_info("Stream hint does not match the first frame: probing the input");
+        _is_hint_rejected = true;
+        return false;
     }
 
-    _dst_frame->format = AVPixelFormat::AV_PIX_FMT_BGR24;
-    _dst_frame->width = _codec_ctx->width;
-    _dst_frame->height = _codec_ctx->height;
-    if (auto r = av_frame_get_buffer(_dst_frame, 0); r < 0)
+    if (_decode_options.pipeline_depth > 0 || _decode_options.latest_frame)
     {
-        log_error("av_frame_get_buffer", vio::logger::get().err2str(r));
-        return false;
+        if (!_ready_frame)
+        {
+            if (_ready_frame = av_frame_alloc(); !_ready_frame)
+            {
+                log_error("av_frame_alloc");
+                return false;
+            }
+        }
+
+        // Latest frame mode: a couple of packets are enough to keep the decoding thread busy
+        const int depth = _decode_options.pipeline_depth > 0 ? _decode_options.pipeline_depth : 2;
+        _pipeline = std::make_unique<pipeline>(*this, depth);
+        _pipeline->start();
+        log_info(_decode_options.latest_frame ? "Latest frame reading, queue size:" : "Pipelined reading, queue size:", depth);
     }
 
     log_info("Video Reader is opened correctly");
     return true;
 }
 
-bool video_reader::is_opened() const
+void video_reader::setup_demuxer()
 {
-    return _codec_ctx != nullptr && _format_ctx != nullptr;
+    // The demuxing thread of the pipelined and latest frame modes can block while waiting for packets
+    if (_decode_options.non_blocking && _decode_options.pipeline_depth <= 0 && !_decode_options.latest_frame)
+        _format_ctx->flags |= AVFMT_FLAG_NONBLOCK;
+
+    // Demuxers that know the keyframes (e.g. MP4) do not even read the other packets
+    if (_decode_options.keyframes_only)
+        _format_ctx->streams[_stream_index]->discard = AVDISCARD_NONKEY;
 }
 
-bool video_reader::read(uint8_t** data, double* pts)
+void video_reader::setup_threading(const AVCodec* codec)
 {
-    if (!is_opened())
+    if (_decode_support == decode_support::HW)
     {
-        return reset_data(data, pts);
+        _codec_ctx->thread_count = 1;
+        return;
     }
 
-    if (!decode())
+    int thread_count = _decode_options.thread_count;
+    if (thread_count <= 0)
     {
-        return reset_data(data, pts);
+        // Small frames do not have enough work per frame to keep many threads busy
+        const int pixels = _codec_ctx->width * _codec_ctx->height;
+        const int max_threads = pixels <= 640 * 480 ? 4 : (pixels <= 1280 * 720 ? 8 : 16);
+        const int cores = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+        thread_count = std::min(cores, max_threads);
     }
 
-    if (!convert(data, pts))
+    int thread_type = 0;
+    switch (_decode_options.threading)
     {
-        return reset_data(data, pts);
-    }
-
-    // ++current_frame;
-    return true;
-}
-
-void video_reader::release()
-{
-    log_info("Release video reader");
-
-    if (_sws_ctx)
-        sws_freeContext(_sws_ctx);
+    case decode_threading::frame:
+        thread_type = FF_THREAD_FRAME;
+        break;
 
-    if (_codec_ctx)
-        avcodec_free_context(&_codec_ctx);
+    case decode_threading::slice:
+        thread_type = FF_THREAD_SLICE;
+        break;
 
-    if (_format_ctx)
+    case decode_threading::automatic:
     {
-        avformat_close_input(&_format_ctx);
-        avformat_free_context(_format_ctx);
+        // Frame threading gives the best throughput but delays each frame by one frame per thread:
+        // network streams and devices are latency sensitive, so prefer slice threading there.
+        const bool is_live = is_live_input();
+        const bool has_frame_threads = codec->capabilities & AV_CODEC_CAP_FRAME_THREADS;
+        const bool has_slice_threads = codec->capabilities & AV_CODEC_CAP_SLICE_THREADS;
+
+        if (has_frame_threads && !(is_live && has_slice_threads))
+            thread_type = FF_THREAD_FRAME;
+        else
+            thread_type = FF_THREAD_SLICE;
+        break;
+    }
     }
 
-    if (_options)
-        av_dict_free(&_options);
-
-    if (_packet)
-        av_packet_free(&_packet);
-
-    if (_src_frame)
-        av_frame_free(&_src_frame);
-
-    if (_dst_frame)
-        av_frame_free(&_dst_frame);
-
-    if (_tmp_frame && _decode_support == decode_support::HW)
-        av_frame_free(&_tmp_frame);
-
-    init();
-
-    if (_decode_support == decode_support::HW)
-        _hw->release();
+    _codec_ctx->thread_count = thread_count;
+    _codec_ctx->thread_type = thread_type;
+    log_info("Decoder threads:", thread_count, "type:", (thread_type == FF_THREAD_FRAME ? "frame" : "slice"));
 }
 
-auto video_reader::get_frame_count() const -> std::optional<int>
+void video_reader::setup_lowres(const AVCodec* codec)
 {
-    if (!is_opened())
+    const int max_lowres = codec->max_lowres;
+    if (!_output_options.allow_lowres || max_lowres <= 0 || _decode_support == decode_support::HW)
+        return;
+
+    if (_output_options.width <= 0 && _output_options.height <= 0)
+        return;
+
+    // Use the largest power-of-two reduction that still decodes at least at the requested output size
+    int lowres = 0;
+    while (lowres < max_lowres
+           && (_codec_ctx->width >> (lowres + 1)) >= _output_options.width
+           && (_codec_ctx->height >> (lowres + 1)) >= _output_options.height)
     {
-        log_error("Frame count not available. Video path must be opened first.");
-        return std::nullopt;
+        ++lowres;
     }
 
-    auto nb_frames = _format_ctx->streams[_stream_index]->nb_frames;
-    if (!nb_frames)
+    if (lowres > 0)
     {
-        double duration_sec = static_cast<double>(_format_ctx->duration) / static_cast<double>(AV_TIME_BASE);
-        auto fps = get_fps();
-        nb_frames = static_cast<int64_t>(std::floor(duration_sec * fps.value() + 0.5));
+        _codec_ctx->lowres = lowres;
+        log_info("Low resolution decoding:", _codec_ctx->width >> lowres, "x", _codec_ctx->height >> lowres);
     }
-    if (nb_frames)
-        return std::make_optional(static_cast<int>(nb_frames));
-
-    return std::nullopt;
 }
 
-auto video_reader::get_duration() const -> std::optional<std::chrono::steady_clock::duration>
+void video_reader::setup_output_size()
 {
-    if (!is_opened())
-    {
-        log_error("Duration not available. Video path must be opened first.");
-        return std::nullopt;
-    }
+    const int width = _codec_ctx->width;
+    const int height = _codec_ctx->height;
+    _output_width = width;
+    _output_height = height;
 
-    auto duration = std::chrono::duration<int64_t, std::ratio<1, AV_TIME_BASE>>(_format_ctx->duration);
-    return std::make_optional(duration);
-}
+    // Native output is never converted, so it always has the decoded size
+    if (_output_options.format == pixel_format::native)
+        return;
 
-auto video_reader::get_frame_size() const -> std::optional<std::tuple<int, int>>
-{
-    if (!is_opened())
+    if (_output_options.width > 0 && _output_options.height > 0)
     {
-        log_error("Frame size not available. Video path must be opened first.");
-        return std::nullopt;
+        _output_width = _output_options.width;
+        _output_height = _output_options.height;
+    }
+    else if (_output_options.width > 0)
+    {
+        _output_width = _output_options.width;
+        _output_height = std::max(2, static_cast<int>(static_cast<int64_t>(height) * _output_width / width) & ~1);
+    }
+    else if (_output_options.height > 0)
+    {
+        _output_height = _output_options.height;
+        _output_width = std::max(2, static_cast<int>(static_cast<int64_t>(width) * _output_height / height) & ~1);
     }
 
-    auto size = std::make_tuple(_codec_ctx->width, _codec_ctx->height);
-    return std::make_optional(size);
+    if (_output_width != width || _output_height != height)
+        log_info("Output frame size:", _output_width, "x", _output_height);
 }
 
-auto video_reader::get_frame_size_in_bytes() const -> std::optional<int>
+void video_reader::setup_frame_pool()
 {
-    if (!is_opened())
+    // Native frames are handed out as decoded, never copied to an output buffer
+    if (_output_options.format == pixel_format::native)
+        return;
+
+    const int format = get_output_pixel_format();
+    if (auto& pool = _output_options.pool; pool && pool->matches(format, _output_width, _output_height))
     {
-        log_error("Frame size in bytes not available. Video path must be opened first.");
-        return std::nullopt;
+        _frame_pool = pool;
+        return;
     }
 
-    auto bytes = _codec_ctx->width * _codec_ctx->height * 3;
-    return std::make_optional(bytes);
+    if (_output_options.pool)
+        log_info("Frame pool ignored: format or size different from the output");
+
+    // Readers with the same output format and size share their buffers
+    _frame_pool = frame_pool::get_shared(format, _output_width, _output_height, frame_pool::default_alignment);
 }
 
-auto video_reader::get_fps() const -> std::optional<double>
+void video_reader::load_index(const char* video_path)
 {
-    if (!is_opened())
-    {
-        log_error("FPS not available. Video path must be opened first.");
-        return std::nullopt;
-    }
+    // The sidecar index is optional: it is only used if it still matches the file (see video_index::build)
+    auto index = std::make_unique<video_index>();
+    if (!index->load(video_path))
+        return;
 
-    auto frame_rate = _format_ctx->streams[_stream_index]->avg_frame_rate;
-    if (frame_rate.num <= 0 || frame_rate.den <= 0)
+    const auto time_base = _format_ctx->streams[_stream_index]->time_base;
+    if (!index->is_up_to_date(video_path) || index->get_stream_index() != _stream_index || index->get_time_base() != std::make_tuple(time_base.num, time_base.den))
     {
-        log_info("Unable to convert FPS.");
-        return std::nullopt;
+        log_info("Video index is out of date:", video_index::get_sidecar_path(video_path));
+        return;
     }
 
-    auto fps = static_cast<double>(frame_rate.num) / static_cast<double>(frame_rate.den);
-    return std::make_optional(fps);
+    log_info("Video index loaded:", video_index::get_sidecar_path(video_path));
+    _index = std::move(index);
 }
 
-bool video_reader::decode()
+void video_reader::setup_subsampling()
 {
-    while (true)
-    {
-        int ret = 0;
-        av_packet_unref(_packet);
+    if (_decode_options.target_fps <= 0.0)
+        return;
 
-        ret = av_read_frame(_format_ctx, _packet);
-        if (ret == AVERROR(EAGAIN))
-            continue;
+    // Distance between selected frames, in the stream time base
+    const auto time_base = _format_ctx->streams[_stream_index]->time_base;
+    _select_interval = std::max<int64_t>(1, std::llround(time_base.den / (time_base.num * _decode_options.target_fps)));
+    log_info("Target FPS:", _decode_options.target_fps);
+}
 
-        if (ret == AVERROR_EOF)
-        {
-            // Create a dummy packet in order to flush cached frames from the decoder
-            _packet->data = nullptr;
-            _packet->size = 0;
-            _packet->stream_index = _stream_index;
-        }
+bool video_reader::setup_bitstream_filter()
+{
+    if (!_decode_options.annexb)
+        return true;
 
-        if (_packet->stream_index != _stream_index)
-            continue;
+    const AVStream* stream = _format_ctx->streams[_stream_index];
+    const char* filter_name = nullptr;
+    if (stream->codecpar->codec_id == AV_CODEC_ID_H264)
+        filter_name = "h264_mp4toannexb";
+    else if (stream->codecpar->codec_id == AV_CODEC_ID_HEVC)
+        filter_name = "hevc_mp4toannexb";
 
-        avcodec_send_packet(_codec_ctx, _packet);
+    if (!filter_name)
+    {
+        log_info("Annex-B conversion not applicable to codec", avcodec_get_name(stream->codecpar->codec_id));
+        return true;
+    }
 
-        ret = avcodec_receive_frame(_codec_ctx, _src_frame);
-        if (ret == AVERROR(EAGAIN))
-            continue;
+    // Packets that already have start codes (e.g. raw .h264 files) are passed through by the filter
+    const AVBitStreamFilter* filter = av_bsf_get_by_name(filter_name);
+    if (!filter)
+    {
+        log_error("av_bsf_get_by_name", filter_name, "not available in this FFmpeg build");
+        return false;
+    }
 
-        if (ret == AVERROR_EOF)
-        {
-            av_packet_unref(_packet);
-            return false;
-        }
+    if (auto r = av_bsf_alloc(filter, &_bsf_ctx); r < 0)
+    {
+        log_error("av_bsf_alloc", vio::logger::get().err2str(r));
+        return false;
+    }
 
-        break;
+    if (auto r = avcodec_parameters_copy(_bsf_ctx->par_in, stream->codecpar); r < 0)
+    {
+        log_error("avcodec_parameters_copy", vio::logger::get().err2str(r));
+        return false;
     }
 
-    _tmp_frame = _src_frame;
+    _bsf_ctx->time_base_in = stream->time_base;
+    if (auto r = av_bsf_init(_bsf_ctx); r < 0)
+    {
+        log_error("av_bsf_init", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    log_info("Annex-B conversion:", filter_name);
     return true;
 }
 
-bool video_reader::convert(uint8_t** data, double* pts)
+bool video_reader::is_opened() const
 {
-    if (_decode_support == decode_support::HW)
+    // The demuxer context is set whenever the codec context is: it is not read here, as a reconnection may be replacing it
+    return _codec_ctx != nullptr;
+}
+
+bool video_reader::read(uint8_t** data, double* pts)
+{
+    if (!is_opened())
     {
-        if (!copy_hw_frame())
-            return false;
+        return reset_data(data, pts);
     }
 
-    if (!_sws_ctx)
+    if (!next_frame())
     {
-        _sws_ctx = sws_getCachedContext(_sws_ctx,
-                                        _codec_ctx->width, _codec_ctx->height, (AVPixelFormat)_tmp_frame->format,
-                                        _codec_ctx->width, _codec_ctx->height, AVPixelFormat::AV_PIX_FMT_RGB24,
-                                        SWS_BILINEAR, nullptr, nullptr, nullptr);
+        return reset_data(data, pts);
+    }
 
-        if (!_sws_ctx)
-        {
-            log_error("Unable to initialize SwsContext");
-            return false;
-        }
+    if (_decode_support == decode_support::HW && !copy_hw_frame())
+    {
+        return reset_data(data, pts);
     }
 
-    sws_scale(_sws_ctx, _tmp_frame->data, _tmp_frame->linesize, 0, _codec_ctx->height, _dst_frame->data, _dst_frame->linesize);
+    if (!convert())
+    {
+        return reset_data(data, pts);
+    }
 
-    *data = _dst_frame->data[0];
+    *data = get_output_frame()->data[0];
 
     if (pts)
     {
-        const auto time_base = _format_ctx->streams[_stream_index]->time_base;
-        *pts = _tmp_frame->best_effort_timestamp * static_cast<double>(time_base.num) / static_cast<double>(time_base.den);
+        *pts = get_pts(_tmp_frame);
     }
 
     return true;
 }
 
-bool video_reader::reset_data(uint8_t** data, double* pts) const
+bool video_reader::read(frame& f)
 {
-    if (data)
-    {
-        *data = nullptr;
-    }
-
-    if (pts)
+    if (!is_opened() || !next_frame())
     {
-        *pts = -1.0;
+        f.release();
+        return false;
     }
 
-    return false;
-}
-
-bool video_reader::flush()
-{
-    AVPacket* packet = nullptr;
-    if (auto r = avcodec_send_packet(_codec_ctx, packet); r < 0)
+    if (_decode_support == decode_support::HW && !copy_hw_frame())
     {
-        log_error("avcodec_send_packet", vio::logger::get().err2str(r));
+        f.release();
         return false;
     }
 
-    while (true)
+    // A handle that is the only owner of a buffer with the output format and size is converted into directly,
+    // so that buffers can be recycled (e.g. by async_reader) instead of allocating a new one for every frame
+    if (!is_passthrough() && is_reusable(f))
     {
-        if (auto r = avcodec_receive_frame(_codec_ctx, _src_frame); r < 0)
+        if (!scale(f._frame->data, f._frame->linesize, f._frame->format))
         {
-            // the decoder has been fully flushed
-            if (AVERROR_EOF == r)
-                break;
-
-            log_info("avcodec_receive_frame", vio::logger::get().err2str(r));
+            f.release();
             return false;
         }
+
+        f._pts = get_pts(_tmp_frame);
+        return true;
     }
 
-    return true;
-}
+    f.release();
 
-bool video_reader::copy_hw_frame()
-{
-    if (_src_frame->format == _hw->hw_pixel_format)
+    if (!convert())
+        return false;
+
+    if (!f._frame)
     {
-        if (auto r = av_hwframe_transfer_data(_tmp_frame, _src_frame, 0); r < 0)
+        if (f._frame = av_frame_alloc(); !f._frame)
         {
-            log_error("av_hwframe_transfer_data", vio::logger::get().err2str(r));
+            log_error("av_frame_alloc");
             return false;
         }
+    }
 
-        if (auto r = av_frame_copy_props(_tmp_frame, _src_frame); r < 0)
-        {
-            log_error("av_frame_copy_props", vio::logger::get().err2str(r));
-            return false;
-        }
+    // The handle shares the converted buffer: the next convert() allocates a new one instead of overwriting it
+    if (auto r = av_frame_ref(f._frame, get_output_frame()); r < 0)
+    {
+        log_error("av_frame_ref", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    f._pts = get_pts(_tmp_frame);
+    return true;
+}
+
+bool video_reader::read_into(uint8_t* buffer, int stride, size_t size, double* pts)
+{
+    if (pts)
+        *pts = -1.0;
+
+    if (!is_opened())
+        return false;
+
+    if (!buffer || reinterpret_cast<uintptr_t>(buffer) % buffer_alignment != 0 || stride % buffer_alignment != 0)
+    {
+        log_error("read_into: buffer and stride must be aligned to", buffer_alignment, "bytes");
+        return false;
+    }
+
+    uint8_t* dst_data[4] = {};
+    int dst_linesize[4] = {};
+    if (!fill_planes(buffer, stride, size, dst_data, dst_linesize))
+        return false;
+
+    if (!next_frame())
+        return false;
+
+    if (_decode_support == decode_support::HW)
+    {
+        if (!copy_hw_frame())
+            return false;
+    }
+
+    if (is_passthrough())
+    {
+        av_image_copy(dst_data, dst_linesize, const_cast<const uint8_t**>(_tmp_frame->data), _tmp_frame->linesize,
+                      static_cast<AVPixelFormat>(_tmp_frame->format), _tmp_frame->width, _tmp_frame->height);
+    }
+    else if (!scale(dst_data, dst_linesize, get_output_pixel_format()))
+    {
+        return false;
+    }
+
+    if (pts)
+        *pts = get_pts(_tmp_frame);
+
+    return true;
+}
+
+int video_reader::read_batch(uint8_t* buffer, size_t size, int batch_size, double* pts, tensor_layout layout)
+{
+    if (pts)
+        std::fill_n(pts, std::max(batch_size, 0), -1.0);
+
+    if (!is_opened())
+        return 0;
+
+    if (!buffer || batch_size <= 0 || reinterpret_cast<uintptr_t>(buffer) % buffer_alignment != 0)
+    {
+        log_error("read_batch: the buffer must be aligned to", buffer_alignment, "bytes and the batch size must be positive");
+        return 0;
+    }
+
+    const auto format = _output_options.format;
+    const bool is_planar_rgb = format == pixel_format::rgb24 || format == pixel_format::bgr24 || format == pixel_format::rgba || format == pixel_format::bgra || format == pixel_format::gray8;
+    if (format == pixel_format::native || (layout == tensor_layout::nchw && !is_planar_rgb))
+    {
+        log_error("read_batch: unsupported output pixel format");
+        return 0;
+    }
+
+    const auto frame_size = static_cast<size_t>(av_image_get_buffer_size(static_cast<AVPixelFormat>(get_output_pixel_format()), _output_width, _output_height, 1));
+    if (size < frame_size * static_cast<size_t>(batch_size))
+    {
+        log_error("read_batch: buffer too small:", "size:", size, "required size:", frame_size * static_cast<size_t>(batch_size));
+        return 0;
+    }
+
+    // Every frame is converted straight into its slot of the batch: there is no intermediate frame and no copy
+    int frame_count = 0;
+    for (; frame_count < batch_size; ++frame_count)
+    {
+        if (!next_frame())
+            break;
+
+        if (_decode_support == decode_support::HW)
+        {
+            if (!copy_hw_frame())
+                break;
+        }
+
+        uint8_t* dst_data[4] = {};
+        int dst_linesize[4] = {};
+        const int dst_pixel_format = fill_tensor_planes(buffer + frame_size * frame_count, layout, dst_data, dst_linesize);
+
+        if (dst_pixel_format == _tmp_frame->format && is_passthrough())
+        {
+            av_image_copy(dst_data, dst_linesize, const_cast<const uint8_t**>(_tmp_frame->data), _tmp_frame->linesize,
+                          static_cast<AVPixelFormat>(_tmp_frame->format), _tmp_frame->width, _tmp_frame->height);
+        }
+        else if (!scale(dst_data, dst_linesize, dst_pixel_format))
+        {
+            break;
+        }
+
+        if (pts)
+            pts[frame_count] = get_pts(_tmp_frame);
+    }
+
+    return frame_count;
+}
+
+bool video_reader::read_packet(packet& p)
+{
+    p.release();
+
+    if (!is_opened())
+        return false;
+
+    // In pipelined and latest frame modes the packets are consumed by the demuxing thread
+    if (_pipeline)
+    {
+        log_error("read_packet() is not available with decode_options::pipeline_depth or decode_options::latest_frame");
+        return false;
+    }
+
+    if (!p._packet)
+    {
+        if (p._packet = av_packet_alloc(); !p._packet)
+        {
+            log_error("av_packet_alloc");
+            return false;
+        }
+    }
+
+    _is_end_of_stream = false;
+
+    while (true)
+    {
+        if (_bsf_ctx)
+        {
+            int ret = av_bsf_receive_packet(_bsf_ctx, p._packet);
+            if (ret == 0)
+                break;
+
+            if (ret == AVERROR_EOF)
+            {
+                _is_end_of_stream = true;
+                return false;
+            }
+
+            if (ret != AVERROR(EAGAIN))
+            {
+                log_error("av_bsf_receive_packet", vio::logger::get().err2str(ret));
+                return false;
+            }
+        }
+
+        av_packet_unref(_packet);
+
+        // Non-blocking input with no packet available yet
+        int ret = read_packet();
+        if (ret == AVERROR(EAGAIN))
+            return false;
+
+        if (ret < 0)
+        {
+            // Send a null packet in order to flush the packets buffered by the bitstream filter
+            if (_bsf_ctx)
+            {
+                av_bsf_send_packet(_bsf_ctx, nullptr);
+                continue;
+            }
+
+            _is_end_of_stream = true;
+            return false;
+        }
+
+        if (_packet->stream_index != _stream_index)
+            continue;
+
+        if (_decode_options.keyframes_only && !(_packet->flags & AV_PKT_FLAG_KEY))
+            continue;
+
+        if (!_bsf_ctx)
+        {
+            av_packet_move_ref(p._packet, _packet);
+            break;
+        }
+
+        if (ret = av_bsf_send_packet(_bsf_ctx, _packet); ret < 0)
+        {
+            log_error("av_bsf_send_packet", vio::logger::get().err2str(ret));
+            return false;
+        }
+    }
+
+    // The first packet of a new connection is marked by demux_packet()
+    p._is_discontinuity = p._packet->opaque == _io.get();
+    p._packet->opaque = nullptr;
+    p._packet->time_base = AVRational{_stream_properties.time_base_num, _stream_properties.time_base_den};
+    return true;
+}
+
+bool video_reader::seek(double seconds, seek_mode mode, double* landing_pts)
+{
+    if (landing_pts)
+        *landing_pts = -1.0;
+
+    if (!is_opened())
+    {
+        log_error("Seek not available. Video path must be opened first.");
+        return false;
+    }
+
+    // Same timeline as the pts returned by read()
+    const int64_t timestamp = std::llround(seconds * static_cast<double>(_stream_properties.time_base_den) / static_cast<double>(_stream_properties.time_base_num));
+    return seek_timestamp(timestamp, mode, landing_pts);
+}
+
+bool video_reader::seek_frame(int frame_index, seek_mode mode, double* landing_pts)
+{
+    if (landing_pts)
+        *landing_pts = -1.0;
+
+    if (!is_opened())
+    {
+        log_error("Seek not available. Video path must be opened first.");
+        return false;
+    }
+
+    const AVRational frame_rate = {_stream_properties.frame_rate_num, _stream_properties.frame_rate_den};
+    if (frame_index < 0 || frame_rate.num <= 0 || frame_rate.den <= 0)
+    {
+        log_error("Unable to seek to frame", frame_index);
+        return false;
+    }
+
+    // The index gives the exact timestamp of every frame, also for variable frame rate videos
+    if (_index)
+    {
+        const auto timestamp = _index->get_frame_timestamp(frame_index);
+        if (!timestamp)
+        {
+            log_error("Unable to seek to frame", frame_index);
+            return false;
+        }
+
+        return seek_timestamp(*timestamp, mode, landing_pts);
+    }
+
+    const int64_t start_time = _stream_properties.start_time != AV_NOPTS_VALUE ? _stream_properties.start_time : 0;
+    const AVRational time_base = {_stream_properties.time_base_num, _stream_properties.time_base_den};
+    const int64_t timestamp = start_time + av_rescale_q(frame_index, av_inv_q(frame_rate), time_base);
+    return seek_timestamp(timestamp, mode, landing_pts);
+}
+
+void video_reader::release()
+{
+    log_info("Release video reader");
+
+    // Stop the pipeline threads before releasing the contexts they use (a blocking read or a reconnection is interrupted)
+    _io->abort();
+    _pipeline.reset();
+
+    if (_codec_ctx)
+        avcodec_free_context(&_codec_ctx);
+
+    if (_bsf_ctx)
+        av_bsf_free(&_bsf_ctx);
+
+    if (_format_ctx)
+    {
+        avformat_close_input(&_format_ctx);
+        avformat_free_context(_format_ctx);
+    }
+
+    if (_options)
+        av_dict_free(&_options);
+
+    // Kept for the next open(): only their buffers are released (the frame handles still sharing them keep them)
+    if (_packet)
+        av_packet_unref(_packet);
+
+    for (AVFrame* f : {_src_frame, _dst_frame, _hw_frame, _ready_frame})
+    {
+        if (f)
+            av_frame_unref(f);
+    }
+
+    // Their planes point to the output buffers, which do not outlive the frame pool
+    for (AVFrame* f : _scale_frames)
+        av_frame_free(&f);
+    _scale_frames.clear();
+
+    init();
+    _io->reset();
+
+    _index.reset();
+    _frame_pool.reset();
+    _slice_pool.reset();
+
+    if (_decode_support == decode_support::HW)
+        _hw->release();
+}
+
+void video_reader::interrupt()
+{
+    log_info("Interrupt video reader");
+    _io->abort();
+}
+
+auto video_reader::get_frame_count() const -> std::optional<int>
+{
+    if (!is_opened())
+    {
+        log_error("Frame count not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    if (_index)
+        return _index->get_frame_count();
+
+    auto nb_frames = _stream_properties.frame_count;
+    if (!nb_frames)
+    {
+        double duration_sec = static_cast<double>(_stream_properties.duration) / static_cast<double>(AV_TIME_BASE);
+        auto fps = get_fps();
+        nb_frames = static_cast<int64_t>(std::floor(duration_sec * fps.value() + 0.5));
+    }
+    if (nb_frames)
+        return std::make_optional(static_cast<int>(nb_frames));
+
+    return std::nullopt;
+}
+
+auto video_reader::get_duration() const -> std::optional<std::chrono::steady_clock::duration>
+{
+    if (!is_opened())
+    {
+        log_error("Duration not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    auto duration = std::chrono::duration<int64_t, std::ratio<1, AV_TIME_BASE>>(_stream_properties.duration);
+    return std::make_optional(duration);
+}
+
+auto video_reader::get_frame_size() const -> std::optional<std::tuple<int, int>>
+{
+    if (!is_opened())
+    {
+        log_error("Frame size not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    auto size = std::make_tuple(_output_width, _output_height);
+    return std::make_optional(size);
+}
+
+auto video_reader::get_frame_size_in_bytes() const -> std::optional<int>
+{
+    if (!is_opened())
+    {
+        log_error("Frame size in bytes not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    auto bytes = av_image_get_buffer_size(static_cast<AVPixelFormat>(get_output_pixel_format()), _output_width, _output_height, 1);
+    if (bytes < 0)
+        return std::nullopt;
+
+    return std::make_optional(bytes);
+}
+
+auto video_reader::get_fps() const -> std::optional<double>
+{
+    if (!is_opened())
+    {
+        log_error("FPS not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    const AVRational frame_rate = {_stream_properties.frame_rate_num, _stream_properties.frame_rate_den};
+    if (frame_rate.num <= 0 || frame_rate.den <= 0)
+    {
+        log_info("Unable to convert FPS.");
+        return std::nullopt;
+    }
+
+    auto fps = static_cast<double>(frame_rate.num) / static_cast<double>(frame_rate.den);
+    return std::make_optional(fps);
+}
+
+auto video_reader::get_decode_thread_count() const -> std::optional<int>
+{
+    if (!is_opened())
+    {
+        log_error("Decode thread count not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    // active_thread_type is zero when the codec does not support the requested threading mode
+    const int thread_count = _codec_ctx->active_thread_type ? _codec_ctx->thread_count : 1;
+    return std::make_optional(thread_count);
+}
+
+bool video_reader::has_index() const
+{
+    return _index != nullptr;
+}
+
+bool video_reader::is_end_of_stream() const
+{
+    // read() also fails without reaching the end of the stream when a non-blocking input has no packet available yet
+    return _is_end_of_stream;
+}
+
+bool video_reader::is_probed() const
+{
+    // False when the stream parameters came from a stream hint instead
+    return _is_probed;
+}
+
+auto video_reader::get_reconnect_count() const -> std::optional<int>
+{
+    if (!is_opened())
+    {
+        log_error("Reconnect count not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    return std::make_optional(_io->reconnect_count.load());
+}
+
+auto video_reader::get_skipped_frame_count() const -> std::optional<uint64_t>
+{
+    if (!_pipeline || !_decode_options.latest_frame)
+        return std::nullopt;
+
+    return std::make_optional(_pipeline->get_skipped_frame_count());
+}
+
+auto video_reader::get_pipeline_stats() const -> std::optional<pipeline_stats>
+{
+    if (!_pipeline)
+        return std::nullopt;
+
+    return std::make_optional(_pipeline->get_stats());
+}
+
+auto video_reader::get_frame_pool() const -> std::shared_ptr<frame_pool>
+{
+    return _frame_pool;
+}
+
+auto video_reader::get_stream_hint() const -> std::optional<stream_hint>
+{
+    if (!is_opened())
+    {
+        log_error("Stream hint not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    std::lock_guard lock(_io->context_mutex);
+    return make_stream_hint(_format_ctx, _stream_index);
+}
+
+auto video_reader::get_codec_parameters() const -> std::optional<codec_parameters>
+{
+    if (!is_opened())
+    {
+        log_error("Codec parameters not available. Video path must be opened first.");
+        return std::nullopt;
+    }
+
+    codec_parameters parameters;
+    if (!parameters._parameters)
+    {
+        log_error("avcodec_parameters_alloc");
+        return std::nullopt;
+    }
+
+    // With Annex-B conversion the extradata changes as well
+    std::lock_guard lock(_io->context_mutex);
+    const AVCodecParameters* source = _bsf_ctx ? _bsf_ctx->par_out : _format_ctx->streams[_stream_index]->codecpar;
+    if (auto r = avcodec_parameters_copy(parameters._parameters, source); r < 0)
+    {
+        log_error("avcodec_parameters_copy", vio::logger::get().err2str(r));
+        return std::nullopt;
+    }
+
+    parameters._time_base_num = _stream_properties.time_base_num;
+    parameters._time_base_den = _stream_properties.time_base_den;
+    return std::make_optional(std::move(parameters));
+}
+
+bool video_reader::decode()
+{
+    // The frame a seek landed on has already been decoded
+    if (_has_pending_frame)
+    {
+        _has_pending_frame = false;
+        return true;
+    }
+
+    _is_waiting_for_input = false;
+
+    while (true)
+    {
+        // Drain the frames already buffered by the decoder before feeding it a new packet
+        int ret = avcodec_receive_frame(_codec_ctx, _src_frame);
+        if (ret == 0)
+            break;
+
+        if (ret == AVERROR_EOF)
+            return false;
+
+        if (ret != AVERROR(EAGAIN))
+        {
+            log_error("avcodec_receive_frame", vio::logger::get().err2str(ret));
+            return false;
+        }
+
+        av_packet_unref(_packet);
+
+        ret = read_packet();
+        if (ret == AVERROR(EAGAIN))
+        {
+            // Non-blocking input with no packet available yet: the decoder state is kept for the next call
+            _is_waiting_for_input = true;
+            return false;
+        }
+
+        if (ret < 0)
+        {
+            // Send a null packet in order to flush cached frames from the decoder
+            avcodec_send_packet(_codec_ctx, nullptr);
+            continue;
+        }
+
+        if (_packet->stream_index != _stream_index)
+            continue;
+
+        if (_decode_options.keyframes_only && !(_packet->flags & AV_PKT_FLAG_KEY))
+            continue;
+
+        // First packet of a new connection (see demux_packet): the frames of the previous one are dropped and timestamps start over
+        if (_packet->opaque == _io.get())
+        {
+            avcodec_flush_buffers(_codec_ctx);
+            _decoded_frame_count = 0;
+            _next_select_timestamp = AV_NOPTS_VALUE;
+        }
+
+        // Non-reference frames that will be dropped anyway are not needed to decode any other frame
+        if (_select_interval > 0 && !_decode_options.keyframes_only)
+            _codec_ctx->skip_frame = is_frame_dropped(_packet->pts) ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+
+        if (ret = avcodec_send_packet(_codec_ctx, _packet); ret < 0)
+            log_info("avcodec_send_packet", vio::logger::get().err2str(ret));
+    }
+
+    av_packet_unref(_packet);
+    return true;
+}
+
+int video_reader::read_packet()
+{
+    // In pipelined mode packets come from the demuxing thread
+    if (_pipeline && _pipeline->is_running())
+        return _pipeline->pop_packet(_packet);
+
+    return demux_packet(_packet);
+}
+
+int video_reader::demux_packet(AVPacket* packet)
+{
+    // After a failed reconnection the previous (dead) connection is kept until release(), so that the demuxer context is never null
+    while (!_io->is_input_lost)
+    {
+        _io->set_deadline(_input_options.read_timeout);
+        int r = av_read_frame(_format_ctx, packet);
+        _io->clear_deadline();
+
+        if (r >= 0 && packet->stream_index == _stream_index)
+        {
+            _io->packet_received();
+            if (std::exchange(_io->is_reconnected, false))
+                packet->opaque = _io.get();
+            return r;
+        }
+
+        if (r >= 0 || r == AVERROR(EAGAIN))
+        {
+            if (!_io->is_idle(_input_options.idle_timeout))
+            {
+                // Packets of the other streams are skipped by the callers
+                if (r >= 0 || _format_ctx->flags & AVFMT_FLAG_NONBLOCK)
+                    return r;
+
+                // Some demuxers have no data yet even when blocking: wait a little instead of spinning
+                if (_io->wait(std::chrono::milliseconds(1)))
+                    continue;
+            }
+
+            av_packet_unref(packet);
+            r = AVERROR(ETIMEDOUT);
+        }
+
+        if (_io->is_aborted())
+            return AVERROR_EXIT;
+
+        if (_io->is_timed_out())
+            r = AVERROR(ETIMEDOUT);
+
+        if (r == AVERROR(ETIMEDOUT))
+            log_error("No data from the input within the timeout");
+
+        // Files end there: only live inputs are read again from a new connection
+        if (_input_options.reconnect_attempts == 0 || !is_live_input())
+            return r;
+
+        if (!reconnect())
+        {
+            _io->is_input_lost = true;
+            return r;
+        }
+    }
+
+    return AVERROR_EOF;
+}
+
+bool video_reader::is_live_input() const
+{
+    // Network streams and devices have no seekable byte stream (or none at all, e.g. RTSP), unlike files
+    return !_format_ctx->pb || !(_format_ctx->pb->seekable & AVIO_SEEKABLE_NORMAL);
+}
+
+bool video_reader::reconnect()
+{
+    // The new connection is expected to carry the same stream: it is not probed, and the decoder is kept
+    const auto hint = make_stream_hint(_format_ctx, _stream_index);
+
+    auto delay = _input_options.reconnect_delay;
+    for (int attempt = 1; _input_options.reconnect_attempts < 0 || attempt <= _input_options.reconnect_attempts; ++attempt)
+    {
+        log_info("Reconnecting to", _input_path, "attempt", attempt);
+
+        if (AVFormatContext* fmt_ctx = reopen_input(hint); fmt_ctx)
+        {
+            if (!is_same_stream(fmt_ctx, hint))
+            {
+                log_error("The stream changed: the input must be opened again");
+                avformat_close_input(&fmt_ctx);
+                return false;
+            }
+
+            // The previous context is only released once the new one replaced it (see get_stream_hint, get_codec_parameters)
+            {
+                std::lock_guard lock(_io->context_mutex);
+                std::swap(_format_ctx, fmt_ctx);
+            }
+            avformat_close_input(&fmt_ctx);
+
+            setup_demuxer();
+            _io->packet_received();
+            _io->is_reconnected = true;
+            ++_io->reconnect_count;
+            log_info("Reconnected to", _input_path);
+            return true;
+        }
+
+        if (!_io->wait(delay))
+            return false;
+
+        delay = std::min(delay * 2, _input_options.max_reconnect_delay);
+    }
+
+    log_error("Unable to reconnect to", _input_path);
+    return false;
+}
+
+AVFormatContext* video_reader::reopen_input(const std::optional<stream_hint>& hint)
+{
+    AVFormatContext* fmt_ctx = avformat_alloc_context();
+    if (!fmt_ctx)
+    {
+        log_error("avformat_alloc_context");
+        return nullptr;
+    }
+
+    _io->attach(fmt_ctx);
+
+    if (!setup_input_options())
+    {
+        avformat_free_context(fmt_ctx);
+        return nullptr;
+    }
+
+    _io->set_deadline(_input_options.open_timeout);
+
+    // On failure the context is freed by avformat_open_input()
+    if (auto r = avformat_open_input(&fmt_ctx, _input_path.c_str(), nullptr, &_options); r < 0)
+    {
+        _io->clear_deadline();
+        av_dict_free(&_options);
+        log_error("avformat_open_input", _io->is_timed_out() ? "timed out" : vio::logger::get().err2str(r));
+        return nullptr;
+    }
+
+    av_dict_free(&_options);
+
+    if (!hint || !apply_stream_hint(fmt_ctx, *hint))
+    {
+        if (auto r = avformat_find_stream_info(fmt_ctx, nullptr); r < 0)
+        {
+            _io->clear_deadline();
+            log_error("avformat_find_stream_info", _io->is_timed_out() ? "timed out" : vio::logger::get().err2str(r));
+            avformat_close_input(&fmt_ctx);
+            return nullptr;
+        }
+    }
+
+    _io->clear_deadline();
+    return fmt_ctx;
+}
+
+bool video_reader::is_same_stream(AVFormatContext* fmt_ctx, const std::optional<stream_hint>& previous) const
+{
+    // Same stream index, time base, codec and codec configuration as the ones the decoder was opened with
+    if (av_find_best_stream(fmt_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, _stream_index, -1, nullptr, 0) != _stream_index)
+        return false;
+
+    const AVStream* stream = fmt_ctx->streams[_stream_index];
+    if (stream->time_base.num != _stream_properties.time_base_num || stream->time_base.den != _stream_properties.time_base_den)
+        return false;
+
+    const AVCodecParameters* codecpar = stream->codecpar;
+    if (codecpar->codec_id != _codec_ctx->codec_id || codecpar->extradata_size != _codec_ctx->extradata_size)
+        return false;
+
+    if (codecpar->extradata_size > 0 && std::memcmp(codecpar->extradata, _codec_ctx->extradata, codecpar->extradata_size) != 0)
+        return false;
+
+    const auto current = make_stream_hint(fmt_ctx, _stream_index);
+    return !previous || (current && current->width == previous->width && current->height == previous->height && current->pixel_format_name == previous->pixel_format_name);
+}
+
+bool video_reader::check_first_frame()
+{
+    // Nothing to check in an empty input, that fails to read anyway
+    if (!decode())
+        return true;
+
+    const auto& hint = *_input_options.hint;
+    const int width = AV_CEIL_RSHIFT(hint.width, _codec_ctx->lowres);
+    const int height = AV_CEIL_RSHIFT(hint.height, _codec_ctx->lowres);
+    if (_src_frame->width != width || _src_frame->height != height)
+        return false;
+
+    // HW frames have the format of the device
+    if (_decode_support == decode_support::SW && _src_frame->format != av_get_pix_fmt(hint.pixel_format_name.c_str()))
+        return false;
+
+    // The frame is returned by the first read, as after a seek
+    _has_pending_frame = true;
+    return true;
+}
+
+bool video_reader::next_frame()
+{
+    // Pipelined frames are already converted, so the read functions hand them out as they are (latest frame mode: they convert it)
+    if (_pipeline)
+    {
+        if (!_pipeline->pop_frame(_ready_frame))
+        {
+            _is_end_of_stream = true;
+            return false;
+        }
+
+        _tmp_frame = _ready_frame;
+        return true;
+    }
+
+    // Frames dropped by the temporal subsampling are never converted
+    while (decode())
+    {
+        if (is_frame_selected())
+        {
+            _tmp_frame = _src_frame;
+            return true;
+        }
+    }
+
+    _is_end_of_stream = !_is_waiting_for_input;
+    return false;
+}
+
+bool video_reader::is_frame_selected()
+{
+    if (_select_interval > 0)
+    {
+        const int64_t timestamp = _src_frame->best_effort_timestamp;
+        if (timestamp == AV_NOPTS_VALUE)
+            return true;
+
+        if (is_frame_dropped(timestamp))
+            return false;
+
+        // The selection grid is anchored to the first frame, so the output timestamps are evenly spaced
+        if (_next_select_timestamp == AV_NOPTS_VALUE)
+            _next_select_timestamp = timestamp;
+
+        _next_select_timestamp += ((timestamp - _next_select_timestamp) / _select_interval + 1) * _select_interval;
+        return true;
+    }
+
+    if (_decode_options.frame_step > 1)
+        return _decoded_frame_count++ % _decode_options.frame_step == 0;
+
+    return true;
+}
+
+bool video_reader::is_frame_dropped(int64_t timestamp) const
+{
+    // The next selected timestamp only moves forward, so any earlier frame will never be returned
+    return timestamp != AV_NOPTS_VALUE && _next_select_timestamp != AV_NOPTS_VALUE && timestamp < _next_select_timestamp;
+}
+
+bool video_reader::seek_timestamp(int64_t timestamp, seek_mode mode, double* landing_pts)
+{
+    if (!_pipeline)
+        return seek_decoder(timestamp, mode, landing_pts);
+
+    // The demuxer and the decoder are repositioned on the caller's thread while the pipeline is stopped
+    _pipeline->stop();
+    const bool is_seeked = seek_decoder(timestamp, mode, landing_pts);
+    _pipeline->start();
+    return is_seeked;
+}
+
+bool video_reader::seek_decoder(int64_t timestamp, seek_mode mode, double* landing_pts)
+{
+    // With an index, seek straight to the start of the GOP containing the target
+    int64_t keyframe_timestamp = timestamp;
+    if (_index)
+    {
+        if (const auto keyframe = _index->find_keyframe(timestamp); keyframe)
+            keyframe_timestamp = keyframe->pts != AV_NOPTS_VALUE ? keyframe->pts : keyframe->dts;
+    }
+
+    if (auto r = av_seek_frame(_format_ctx, _stream_index, keyframe_timestamp, AVSEEK_FLAG_BACKWARD); r < 0)
+    {
+        log_error("av_seek_frame", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    flush();
+
+    // The first decoded frame is the keyframe at or before the target
+    if (!decode())
+        return false;
+
+    if (mode == seek_mode::exact)
+    {
+        // Discard frames while the next one is closer to the target, without converting them
+        const int64_t half_frame = get_frame_duration() / 2;
+        while (_src_frame->best_effort_timestamp != AV_NOPTS_VALUE && _src_frame->best_effort_timestamp + half_frame < timestamp)
+        {
+            if (!decode())
+                return false;
+        }
+    }
+
+    // Hand out the landing frame on the next read
+    _has_pending_frame = true;
+
+    if (landing_pts)
+        *landing_pts = get_pts(_src_frame);
+
+    return true;
+}
+
+int64_t video_reader::get_frame_duration() const
+{
+    const auto stream = _format_ctx->streams[_stream_index];
+    if (stream->avg_frame_rate.num <= 0 || stream->avg_frame_rate.den <= 0)
+        return 0;
+
+    return av_rescale_q(1, av_inv_q(stream->avg_frame_rate), stream->time_base);
+}
+
+bool video_reader::convert()
+{
+    if (is_passthrough())
+        return true;
+
+    if (!make_dst_frame_writable())
+        return false;
+
+    return scale(_dst_frame->data, _dst_frame->linesize, _dst_frame->format);
+}
+
+bool video_reader::scale(uint8_t* const dst_data[], const int dst_linesize[], int dst_pixel_format)
+{
+    if (convert_yuv_to_rgb(_tmp_frame, dst_data[0], dst_linesize[0], dst_pixel_format))
+        return true;
+
+    if (_output_options.conversion_threads > 1)
+        return scale_threaded(dst_data, dst_linesize, dst_pixel_format);
+
+    // Colour conversion and resize run in a single pass. The cached context is only rebuilt when the input changes.
+    _sws_ctx = sws_getCachedContext(_sws_ctx,
+                                    _tmp_frame->width, _tmp_frame->height, (AVPixelFormat)_tmp_frame->format,
+                                    _output_width, _output_height, static_cast<AVPixelFormat>(dst_pixel_format),
+                                    get_sws_flags(), nullptr, nullptr, nullptr);
+
+    if (!_sws_ctx)
+    {
+        log_error("Unable to initialize SwsContext");
+        return false;
+    }
+
+    setup_colorspace(_sws_ctx, _tmp_frame, dst_pixel_format);
+    sws_scale(_sws_ctx, _tmp_frame->data, _tmp_frame->linesize, 0, _tmp_frame->height, dst_data, dst_linesize);
+    return true;
+}
+
+bool video_reader::scale_threaded(uint8_t* const dst_data[], const int dst_linesize[], int dst_pixel_format)
+{
+    // swscale converts horizontal bands of the output on its own threads, each one with its own internal context
+    if (!setup_threaded_sws_context(dst_pixel_format))
+        return false;
+
+    setup_colorspace(_sws_ctx, _tmp_frame, dst_pixel_format);
+
+    AVFrame* scale_frame = get_scale_frame(dst_data, dst_linesize, dst_pixel_format);
+    if (!scale_frame)
+        return false;
+
+    if (auto r = sws_scale_frame(_sws_ctx, scale_frame, _tmp_frame); r < 0)
+    {
+        log_error("sws_scale_frame", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    return true;
+}
+
+AVFrame* video_reader::get_scale_frame(uint8_t* const dst_data[], const int dst_linesize[], int dst_pixel_format)
+{
+    // sws_scale_frame() only writes to reference counted frames: every plane is wrapped with a buffer of its own size that owns nothing
+    const ptrdiff_t linesizes[4] = {dst_linesize[0], dst_linesize[1], dst_linesize[2], dst_linesize[3]};
+    size_t plane_sizes[4] = {};
+    if (auto r = av_image_fill_plane_sizes(plane_sizes, static_cast<AVPixelFormat>(dst_pixel_format), _output_height, linesizes); r < 0)
+    {
+        log_error("av_image_fill_plane_sizes", vio::logger::get().err2str(r));
+        return nullptr;
+    }
+
+    auto is_wrapping = [&](const AVFrame* f)
+    {
+        if (f->format != dst_pixel_format || f->width != _output_width || f->height != _output_height)
+            return false;
+
+        for (int plane = 0; plane < 4; ++plane)
+        {
+            const size_t size = f->buf[plane] ? f->buf[plane]->size : 0;
+            if (size != plane_sizes[plane] || (size > 0 && (f->data[plane] != dst_data[plane] || f->linesize[plane] != dst_linesize[plane])))
+                return false;
+        }
+        return true;
+    };
+
+    // The output buffers are recycled by the frame pool (or by the caller): their wrappers are reused instead of being created for every frame
+    if (auto it = std::find_if(_scale_frames.begin(), _scale_frames.end(), is_wrapping); it != _scale_frames.end())
+        return *it;
+
+    static constexpr size_t max_scale_frames = 8;
+    AVFrame* f = nullptr;
+    if (_scale_frames.size() < max_scale_frames)
+    {
+        if (f = av_frame_alloc(); !f)
+        {
+            log_error("av_frame_alloc");
+            return nullptr;
+        }
+        _scale_frames.push_back(f);
+    }
+    else
+    {
+        // The oldest wrapper is replaced
+        std::rotate(_scale_frames.begin(), _scale_frames.begin() + 1, _scale_frames.end());
+        f = _scale_frames.back();
+        av_frame_unref(f);
+    }
+
+    for (int plane = 0; plane < 4 && plane_sizes[plane] > 0; ++plane)
+    {
+        if (f->buf[plane] = av_buffer_create(dst_data[plane], plane_sizes[plane], [](void*, uint8_t*) {}, nullptr, 0); !f->buf[plane])
+        {
+            log_error("av_buffer_create");
+            av_frame_unref(f);
+            return nullptr;
+        }
+
+        f->data[plane] = dst_data[plane];
+        f->linesize[plane] = dst_linesize[plane];
+    }
+
+    f->format = dst_pixel_format;
+    f->width = _output_width;
+    f->height = _output_height;
+    return f;
+}
+
+bool video_reader::setup_threaded_sws_context(int dst_pixel_format)
+{
+    static constexpr const char* names[] = {"srcw", "srch", "src_format", "dstw", "dsth", "dst_format", "sws_flags", "threads"};
+    const int64_t values[] = {_tmp_frame->width, _tmp_frame->height, _tmp_frame->format, _output_width, _output_height, dst_pixel_format, get_sws_flags(), _output_options.conversion_threads};
+
+    // Same as sws_getCachedContext(), which has no thread count: the context is only rebuilt when a parameter changes
+    if (_sws_ctx)
+    {
+        bool is_changed = false;
+        for (size_t i = 0; i < std::size(names) && !is_changed; ++i)
+        {
+            int64_t value = 0;
+            is_changed = av_opt_get_int(_sws_ctx, names[i], 0, &value) < 0 || value != values[i];
+        }
+
+        if (!is_changed)
+            return true;
+
+        sws_freeContext(_sws_ctx);
+    }
+
+    if (_sws_ctx = sws_alloc_context(); !_sws_ctx)
+    {
+        log_error("sws_alloc_context");
+        return false;
+    }
+
+    for (size_t i = 0; i < std::size(names); ++i)
+    {
+        if (auto r = av_opt_set_int(_sws_ctx, names[i], values[i], 0); r < 0)
+        {
+            log_error("av_opt_set_int", names[i], vio::logger::get().err2str(r));
+            sws_freeContext(_sws_ctx);
+            _sws_ctx = nullptr;
+            return false;
+        }
+    }
+
+    if (auto r = sws_init_context(_sws_ctx, nullptr, nullptr); r < 0)
+    {
+        log_error("sws_init_context", vio::logger::get().err2str(r));
+        sws_freeContext(_sws_ctx);
+        _sws_ctx = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+bool video_reader::convert_yuv_to_rgb(const AVFrame* src, uint8_t* dst, int dst_linesize, int dst_pixel_format)
+{
+    // Common case with no resize: hand written kernels, faster than the generic swscale path
+    if (!_output_options.simd_conversion || src->width != _output_width || src->height != _output_height)
+        return false;
+
+    simd::yuv_format src_format;
+    switch (src->format)
+    {
+    case AVPixelFormat::AV_PIX_FMT_YUV420P:
+    case AVPixelFormat::AV_PIX_FMT_YUVJ420P:
+        src_format = simd::yuv_format::yuv420p;
+        break;
+    case AVPixelFormat::AV_PIX_FMT_NV12:
+        src_format = simd::yuv_format::nv12;
+        break;
+    default:
+        return false;
+    }
+
+    simd::rgb_format dst_format;
+    switch (dst_pixel_format)
+    {
+    case AVPixelFormat::AV_PIX_FMT_RGB24:
+        dst_format = simd::rgb_format::rgb24;
+        break;
+    case AVPixelFormat::AV_PIX_FMT_BGR24:
+        dst_format = simd::rgb_format::bgr24;
+        break;
+    case AVPixelFormat::AV_PIX_FMT_RGBA:
+        dst_format = simd::rgb_format::rgba;
+        break;
+    case AVPixelFormat::AV_PIX_FMT_BGRA:
+        dst_format = simd::rgb_format::bgra;
+        break;
+    default:
+        return false;
+    }
+
+    const simd::yuv_planes planes = {{src->data[0], src->data[1], src->data[2]}, {src->linesize[0], src->linesize[1], src->linesize[2]}};
+    const auto coefficients = simd::get_yuv_coefficients(is_bt709(src), is_full_range(src));
+    if (_output_options.conversion_threads <= 1)
+    {
+        simd::yuv_to_rgb(planes, src_format, dst, dst_linesize, dst_format, src->width, 0, src->height, coefficients);
+        return true;
+    }
+
+    // Only the SIMD kernels run on this pool (swscale has its own threads): it is started on the first frame they convert
+    if (!_slice_pool)
+        _slice_pool = std::make_unique<slice_pool>(_output_options.conversion_threads);
+
+    // Bands start on even rows, where a new row of chroma samples starts
+    const int slice_count = _slice_pool->get_thread_count();
+    const int slice_height = ((src->height + slice_count - 1) / slice_count + 1) & ~1;
+    _slice_pool->run(slice_count, [&](int slice) {
+        const int first_row = std::min(src->height, slice * slice_height);
+        const int last_row = std::min(src->height, first_row + slice_height);
+        simd::yuv_to_rgb(planes, src_format, dst, dst_linesize, dst_format, src->width, first_row, last_row, coefficients);
+    });
+    return true;
+}
+
+void video_reader::setup_colorspace(SwsContext* sws_ctx, const AVFrame* src, int dst_pixel_format) const
+{
+    // Same coefficients and range as the SIMD kernels, so that both paths give the same colours
+    const AVPixFmtDescriptor* src_desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(src->format));
+    const AVPixFmtDescriptor* dst_desc = av_pix_fmt_desc_get(static_cast<AVPixelFormat>(dst_pixel_format));
+    if (!src_desc || !dst_desc || (src_desc->flags & AV_PIX_FMT_FLAG_RGB) || !(dst_desc->flags & AV_PIX_FMT_FLAG_RGB))
+        return;
+
+    int* src_coefficients = nullptr;
+    int* dst_coefficients = nullptr;
+    int src_range = 0;
+    int dst_range = 0;
+    int brightness = 0;
+    int contrast = 0;
+    int saturation = 0;
+    if (sws_getColorspaceDetails(sws_ctx, &src_coefficients, &src_range, &dst_coefficients, &dst_range, &brightness, &contrast, &saturation) < 0)
+        return;
+
+    // Only applied when changed: it rebuilds the conversion tables
+    const int* coefficients = sws_getCoefficients(is_bt709(src) ? SWS_CS_ITU709 : SWS_CS_ITU601);
+    const int range = is_full_range(src) ? 1 : 0;
+    if (src_range == range && std::equal(coefficients, coefficients + 4, src_coefficients))
+        return;
+
+    sws_setColorspaceDetails(sws_ctx, coefficients, range, dst_coefficients, dst_range, brightness, contrast, saturation);
+}
+
+bool video_reader::is_bt709(const AVFrame* src) const
+{
+    if (_output_options.yuv_matrix != color_matrix::automatic)
+        return _output_options.yuv_matrix == color_matrix::bt709;
+
+    return src->colorspace == AVColorSpace::AVCOL_SPC_BT709;
+}
+
+bool video_reader::is_full_range(const AVFrame* src) const
+{
+    if (_output_options.yuv_range != color_range::automatic)
+        return _output_options.yuv_range == color_range::full;
+
+    return src->color_range == AVColorRange::AVCOL_RANGE_JPEG || src->format == AVPixelFormat::AV_PIX_FMT_YUVJ420P;
+}
+
+int video_reader::get_sws_flags() const
+{
+    switch (_output_options.resize_interpolation)
+    {
+    case interpolation::nearest:
+        return SWS_POINT;
+    case interpolation::fast_bilinear:
+        return SWS_FAST_BILINEAR;
+    case interpolation::bicubic:
+        return SWS_BICUBIC;
+    case interpolation::area:
+        return SWS_AREA;
+    case interpolation::bilinear:
+    default:
+        return SWS_BILINEAR;
+    }
+}
+
+bool video_reader::fill_planes(uint8_t* buffer, int stride, size_t size, uint8_t* dst_data[], int dst_linesize[]) const
+{
+    const auto pix_fmt = static_cast<AVPixelFormat>(get_output_pixel_format());
+
+    // Scale the minimum linesize of every plane by the caller's stride, e.g. YUV420P chroma planes use half of it
+    int min_linesize[4] = {};
+    if (auto r = av_image_fill_linesizes(min_linesize, pix_fmt, _output_width); r < 0 || stride < min_linesize[0])
+    {
+        log_error("read_into: stride too small:", stride, "required stride:", min_linesize[0]);
+        return false;
+    }
+
+    for (int plane = 0; plane < 4 && min_linesize[plane] > 0; ++plane)
+        dst_linesize[plane] = static_cast<int>(static_cast<int64_t>(stride) * min_linesize[plane] / min_linesize[0]);
+
+    const int required_size = av_image_fill_pointers(dst_data, pix_fmt, _output_height, buffer, dst_linesize);
+    if (required_size < 0 || size < static_cast<size_t>(required_size))
+    {
+        log_error("read_into: buffer too small:", "size:", size, "required size:", required_size);
+        return false;
+    }
+
+    return true;
+}
+
+int video_reader::fill_tensor_planes(uint8_t* buffer, tensor_layout layout, uint8_t* dst_data[], int dst_linesize[]) const
+{
+    const int pix_fmt = get_output_pixel_format();
+    if (layout == tensor_layout::nhwc || _output_options.format == pixel_format::gray8)
+    {
+        av_image_fill_arrays(dst_data, dst_linesize, buffer, static_cast<AVPixelFormat>(pix_fmt), _output_width, _output_height, 1);
+        return pix_fmt;
+    }
+
+    // swscale writes planar RGB as G, B, R (and A) planes: point each plane at the offset of its channel
+    const size_t plane_size = static_cast<size_t>(_output_width) * _output_height;
+    const bool is_bgr = _output_options.format == pixel_format::bgr24 || _output_options.format == pixel_format::bgra;
+    const bool has_alpha = _output_options.format == pixel_format::rgba || _output_options.format == pixel_format::bgra;
+
+    dst_data[0] = buffer + plane_size;                    // G
+    dst_data[1] = buffer + plane_size * (is_bgr ? 0 : 2); // B
+    dst_data[2] = buffer + plane_size * (is_bgr ? 2 : 0); // R
+    dst_data[3] = has_alpha ? buffer + plane_size * 3 : nullptr;
+    for (int plane = 0; plane < (has_alpha ? 4 : 3); ++plane)
+        dst_linesize[plane] = _output_width;
+
+    return has_alpha ? AVPixelFormat::AV_PIX_FMT_GBRAP : AVPixelFormat::AV_PIX_FMT_GBRP;
+}
+
+int video_reader::get_output_pixel_format() const
+{
+    if (_output_options.format == pixel_format::native)
+    {
+        // HW frames are downloaded as NV12 (see hw_acceleration::get_frames_ctx)
+        return _decode_support == decode_support::HW ? AVPixelFormat::AV_PIX_FMT_NV12 : _codec_ctx->pix_fmt;
+    }
+
+    return to_av_pixel_format(_output_options.format);
+}
+
+bool video_reader::is_passthrough() const
+{
+    // Decoded frames that are already in the output format are handed out without going through swscale
+    if (_output_options.format == pixel_format::native)
+        return true;
+
+    return _tmp_frame->format == get_output_pixel_format() && _tmp_frame->width == _output_width && _tmp_frame->height == _output_height;
+}
+
+bool video_reader::is_reusable(const frame& f) const
+{
+    const AVFrame* dst = f._frame;
+    return dst && dst->buf[0] && av_frame_is_writable(const_cast<AVFrame*>(dst)) && dst->format == get_output_pixel_format()
+           && dst->width == _output_width && dst->height == _output_height;
+}
+
+AVFrame* video_reader::get_output_frame() const
+{
+    return is_passthrough() ? _tmp_frame : _dst_frame;
+}
+
+bool video_reader::make_dst_frame_writable()
+{
+    if (av_frame_is_writable(_dst_frame))
+        return true;
+
+    // The current buffer (if any) is still referenced by a frame handle: take another one rather than overwriting it
+    if (!_frame_pool->get(_dst_frame))
+    {
+        log_error("Unable to get an output buffer from the frame pool");
+        return false;
+    }
+
+    return true;
+}
+
+double video_reader::get_pts(const AVFrame* frame) const
+{
+    return frame->best_effort_timestamp * static_cast<double>(_stream_properties.time_base_num) / static_cast<double>(_stream_properties.time_base_den);
+}
+
+bool video_reader::reset_data(uint8_t** data, double* pts) const
+{
+    if (data)
+    {
+        *data = nullptr;
+    }
+
+    if (pts)
+    {
+        *pts = -1.0;
+    }
+
+    return false;
+}
+
+void video_reader::flush()
+{
+    // Drop the frames and packets buffered by the decoder (this also resets the draining state after EOF)
+    avcodec_flush_buffers(_codec_ctx);
+    av_packet_unref(_packet);
+
+    if (_bsf_ctx)
+        av_bsf_flush(_bsf_ctx);
+    _has_pending_frame = false;
+    _is_end_of_stream = false;
+
+    // Restart the temporal subsampling from the frame the seek lands on
+    _decoded_frame_count = 0;
+    _next_select_timestamp = AV_NOPTS_VALUE;
+}
+
+bool video_reader::copy_hw_frame()
+{
+    // Pipelined frames are downloaded by the conversion thread, except in latest frame mode
+    if (_pipeline && !_decode_options.latest_frame)
+        return true;
+
+    AVFrame* decoded_frame = _pipeline ? _ready_frame : _src_frame;
+    if (decoded_frame->format == _hw->hw_pixel_format)
+    {
+        if (auto r = av_hwframe_transfer_data(_hw_frame, decoded_frame, 0); r < 0)
+        {
+            log_error("av_hwframe_transfer_data", vio::logger::get().err2str(r));
+            return false;
+        }
+
+        if (auto r = av_frame_copy_props(_hw_frame, decoded_frame); r < 0)
+        {
+            log_error("av_frame_copy_props", vio::logger::get().err2str(r));
+            return false;
+        }
+
+        _tmp_frame = _hw_frame;
     }
     else
     {
-        _tmp_frame = _src_frame;
+        _tmp_frame = decoded_frame;
     }
 
     return true;
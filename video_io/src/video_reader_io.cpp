@@ -0,0 +1,114 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "video_reader_io.hpp"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+namespace tc::vio
+{
+video_reader::io_control::io_control()
+    : reconnect_count{0}
+    , is_reconnected{false}
+    , is_input_lost{false}
+    , _deadline{no_deadline}
+    , _is_timed_out{false}
+    , _is_aborted{false}
+    , _last_packet{clock::now()}
+{
+}
+
+void video_reader::io_control::attach(AVFormatContext* fmt_ctx)
+{
+    fmt_ctx->interrupt_callback.callback = &io_control::interrupt_callback;
+    fmt_ctx->interrupt_callback.opaque = this;
+}
+
+void video_reader::io_control::set_deadline(std::chrono::milliseconds timeout)
+{
+    _is_timed_out = false;
+    _deadline = timeout.count() > 0 ? (clock::now() + timeout).time_since_epoch().count() : no_deadline;
+}
+
+void video_reader::io_control::clear_deadline()
+{
+    _deadline = no_deadline;
+}
+
+bool video_reader::io_control::is_timed_out() const
+{
+    return _is_timed_out;
+}
+
+void video_reader::io_control::abort()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _is_aborted = true;
+    }
+    _abort_condition.notify_all();
+}
+
+bool video_reader::io_control::is_aborted() const
+{
+    return _is_aborted;
+}
+
+bool video_reader::io_control::wait(std::chrono::milliseconds delay)
+{
+    std::unique_lock lock(_mutex);
+    return !_abort_condition.wait_for(lock, delay, [this] { return _is_aborted.load(); });
+}
+
+void video_reader::io_control::reset()
+{
+    std::lock_guard lock(_mutex);
+    _is_aborted = false;
+    _is_timed_out = false;
+    _deadline = no_deadline;
+    _last_packet = clock::now();
+    reconnect_count = 0;
+    is_reconnected = false;
+    is_input_lost = false;
+}
+
+void video_reader::io_control::packet_received()
+{
+    _last_packet = clock::now();
+}
+
+bool video_reader::io_control::is_idle(std::chrono::milliseconds timeout) const
+{
+    return timeout.count() > 0 && clock::now() - _last_packet > timeout;
+}
+
+int video_reader::io_control::interrupt_callback(void* opaque)
+{
+    auto* io = static_cast<io_control*>(opaque);
+    if (io->_is_aborted)
+        return 1;
+
+    if (clock::now().time_since_epoch().count() > io->_deadline)
+    {
+        io->_is_timed_out = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+}
@@ -0,0 +1,69 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/video_reader.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace tc::vio
+{
+// Deadlines of the blocking I/O of video_reader, through the interrupt callback of its AVFormatContext:
+// FFmpeg polls it while connecting, probing and waiting for data, and gives up as soon as it returns 1.
+struct video_reader::io_control
+{
+    using clock = std::chrono::steady_clock;
+
+    explicit io_control();
+
+    void attach(AVFormatContext* fmt_ctx);
+    void set_deadline(std::chrono::milliseconds timeout); // of the next operation, 0: none
+    void clear_deadline();
+    bool is_timed_out() const;
+
+    void abort(); // interrupt the operation in progress, the next ones and any wait() until reset()
+    bool is_aborted() const;
+    bool wait(std::chrono::milliseconds delay); // false if aborted
+    void reset();
+
+    void packet_received();
+    bool is_idle(std::chrono::milliseconds timeout) const; // no packet for longer than timeout (never if 0)
+
+    static int interrupt_callback(void* opaque);
+
+    std::atomic<int> reconnect_count;
+    bool is_reconnected; // until the first packet of the new connection is read
+    bool is_input_lost;  // the reconnection failed: the stream has ended
+
+    // Held while the demuxer context is replaced, and by the caller's thread to read it
+    std::mutex context_mutex;
+
+private:
+    static constexpr int64_t no_deadline = INT64_MAX;
+
+    std::atomic<int64_t> _deadline; // clock ticks
+    std::atomic<bool> _is_timed_out;
+    std::atomic<bool> _is_aborted;
+    clock::time_point _last_packet;
+
+    std::mutex _mutex;
+    std::condition_variable _abort_condition;
+};
+
+}
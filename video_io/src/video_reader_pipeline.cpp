@@ -0,0 +1,343 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "video_reader_pipeline.hpp"
+
+#include <teiacare/video_io/frame_pool.hpp>
+
+#include "logger.hpp"
+#include "video_reader_hw.hpp"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavutil/hwcontext.h>
+#include <libswscale/swscale.h>
+}
+
+namespace tc::vio
+{
+namespace
+{
+int64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+video_reader::pipeline::pipeline(video_reader& reader, int depth)
+    : _reader{reader}
+    , _packets{static_cast<size_t>(depth)}
+    , _decoded_frames{static_cast<size_t>(depth)}
+    , _converted_frames{static_cast<size_t>(depth)}
+    , _latest_frame{1}
+    , _is_running{false}
+    , _is_latest_frame{reader._decode_options.latest_frame}
+    , _sws_ctx{nullptr}
+    , _skipped_frames{0}
+{
+}
+
+video_reader::pipeline::~pipeline()
+{
+    stop();
+
+    if (_sws_ctx)
+        sws_freeContext(_sws_ctx);
+}
+
+void video_reader::pipeline::start()
+{
+    if (_is_running)
+        return;
+
+    _packets.reset();
+    _decoded_frames.reset();
+    _converted_frames.reset();
+    _latest_frame.reset();
+    _is_running = true;
+
+    _demux_thread = std::thread(&pipeline::demux_loop, this);
+    _decode_thread = std::thread(&pipeline::decode_loop, this);
+
+    // Latest frame mode: converted on the caller's thread when popped
+    if (!_is_latest_frame)
+        _convert_thread = std::thread(&pipeline::convert_loop, this);
+}
+
+void video_reader::pipeline::stop()
+{
+    if (!_is_running)
+        return;
+
+    // Closing the queues wakes up every stage, whether it is waiting for input or for space in the next queue
+    _packets.close();
+    _decoded_frames.close();
+    _converted_frames.close();
+    _latest_frame.close();
+
+    _demux_thread.join();
+    _decode_thread.join();
+    if (_convert_thread.joinable())
+        _convert_thread.join();
+
+    _packets.reset();
+    _decoded_frames.reset();
+    _converted_frames.reset();
+    _latest_frame.reset();
+    _is_running = false;
+}
+
+bool video_reader::pipeline::is_running() const
+{
+    return _is_running;
+}
+
+packet_ptr video_reader::pipeline::alloc_packet()
+{
+    return packet_ptr(_packet_shells.acquire(), packet_deleter{&_packet_shells});
+}
+
+frame_ptr video_reader::pipeline::alloc_frame()
+{
+    return frame_ptr(_frame_shells.acquire(), frame_deleter{&_frame_shells});
+}
+
+void video_reader::pipeline::demux_loop()
+{
+    while (true)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        packet_ptr packet = alloc_packet();
+        if (!packet)
+        {
+            log_error("av_packet_alloc");
+            break;
+        }
+
+        // Blocking, with the deadlines and the reconnection of the input options
+        if (_reader.demux_packet(packet.get()) < 0)
+            break;
+
+        if (packet->stream_index != _reader._stream_index)
+            continue;
+
+        _demux.busy_ns += elapsed_ns(start);
+        ++_demux.items;
+
+        const auto push_start = std::chrono::steady_clock::now();
+        if (!_packets.push(std::move(packet)))
+            return;
+        _demux.idle_ns += elapsed_ns(push_start);
+    }
+
+    // End of stream (or read error)
+    _packets.push(nullptr);
+}
+
+int video_reader::pipeline::pop_packet(AVPacket* packet)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    packet_ptr item;
+    const bool has_item = _packets.pop(item);
+    _decode.idle_ns += elapsed_ns(start);
+
+    if (!has_item || !item)
+    {
+        // Any further pop returns immediately
+        _packets.close();
+        return AVERROR_EOF;
+    }
+
+    av_packet_move_ref(packet, item.get());
+    return 0;
+}
+
+void video_reader::pipeline::decode_loop()
+{
+    while (true)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const int64_t idle_ns = _decode.idle_ns;
+
+        // Same decoding and frame selection as video_reader::next_frame(), fed by the demuxing thread (see read_packet)
+        bool has_frame = false;
+        while ((has_frame = _reader.decode()) && !_reader.is_frame_selected())
+        {
+        }
+
+        if (!has_frame)
+            break;
+
+        frame_ptr f = alloc_frame();
+        if (!f)
+        {
+            log_error("av_frame_alloc");
+            break;
+        }
+        av_frame_move_ref(f.get(), _reader._src_frame);
+
+        // Time spent waiting for packets is accounted as idle time in pop_packet()
+        _decode.busy_ns += elapsed_ns(start) - (_decode.idle_ns - idle_ns);
+        ++_decode.items;
+
+        // The newest frame replaces the one the caller has not popped yet
+        if (_is_latest_frame)
+        {
+            size_t dropped = 0;
+            if (!_latest_frame.push_latest(std::move(f), dropped))
+                return;
+            _skipped_frames += dropped;
+            continue;
+        }
+
+        const auto push_start = std::chrono::steady_clock::now();
+        if (!_decoded_frames.push(std::move(f)))
+            return;
+        _decode.idle_ns += elapsed_ns(push_start);
+    }
+
+    if (_is_latest_frame)
+        _latest_frame.push(nullptr);
+    else
+        _decoded_frames.push(nullptr);
+}
+
+void video_reader::pipeline::convert_loop()
+{
+    while (true)
+    {
+        const auto pop_start = std::chrono::steady_clock::now();
+        frame_ptr src;
+        if (!_decoded_frames.pop(src) || !src)
+            break;
+        _convert.idle_ns += elapsed_ns(pop_start);
+
+        const auto start = std::chrono::steady_clock::now();
+        frame_ptr dst = convert(std::move(src));
+        if (!dst)
+            break;
+
+        _convert.busy_ns += elapsed_ns(start);
+        ++_convert.items;
+
+        const auto push_start = std::chrono::steady_clock::now();
+        if (!_converted_frames.push(std::move(dst)))
+            return;
+        _convert.idle_ns += elapsed_ns(push_start);
+    }
+
+    _converted_frames.push(nullptr);
+}
+
+frame_ptr video_reader::pipeline::convert(frame_ptr src)
+{
+    if (_reader._decode_support == decode_support::HW && src->format == _reader._hw->hw_pixel_format)
+    {
+        frame_ptr sw_frame = alloc_frame();
+        if (!sw_frame)
+        {
+            log_error("av_frame_alloc");
+            return nullptr;
+        }
+
+        if (auto r = av_hwframe_transfer_data(sw_frame.get(), src.get(), 0); r < 0)
+        {
+            log_error("av_hwframe_transfer_data", vio::logger::get().err2str(r));
+            return nullptr;
+        }
+
+        av_frame_copy_props(sw_frame.get(), src.get());
+        src = std::move(sw_frame);
+    }
+
+    if (_reader._output_options.format == pixel_format::native)
+        return src;
+
+    const int format = _reader.get_output_pixel_format();
+    const int width = _reader._output_width;
+    const int height = _reader._output_height;
+    if (src->format == format && src->width == width && src->height == height)
+        return src;
+
+    frame_ptr dst = alloc_frame();
+    if (!dst)
+    {
+        log_error("av_frame_alloc");
+        return nullptr;
+    }
+
+    // Buffers go back to the pool when the frame handles sharing them are released
+    if (!_reader._frame_pool->get(dst.get()))
+    {
+        log_error("Unable to get an output buffer from the frame pool");
+        return nullptr;
+    }
+
+    if (!_reader.convert_yuv_to_rgb(src.get(), dst->data[0], dst->linesize[0], format))
+    {
+        _sws_ctx = sws_getCachedContext(_sws_ctx,
+                                        src->width, src->height, static_cast<AVPixelFormat>(src->format),
+                                        width, height, static_cast<AVPixelFormat>(format),
+                                        _reader.get_sws_flags(), nullptr, nullptr, nullptr);
+        if (!_sws_ctx)
+        {
+            log_error("Unable to initialize SwsContext");
+            return nullptr;
+        }
+
+        _reader.setup_colorspace(_sws_ctx, src.get(), format);
+        sws_scale(_sws_ctx, src->data, src->linesize, 0, src->height, dst->data, dst->linesize);
+    }
+    av_frame_copy_props(dst.get(), src.get());
+    return dst;
+}
+
+bool video_reader::pipeline::pop_frame(AVFrame* frame)
+{
+    frame_ptr item;
+    const bool has_item = _is_latest_frame ? _latest_frame.pop(item) : _converted_frames.pop(item);
+    if (!has_item || !item)
+    {
+        // Any further pop returns immediately
+        if (_is_latest_frame)
+            _latest_frame.close();
+        else
+            _converted_frames.close();
+        return false;
+    }
+
+    av_frame_unref(frame);
+    av_frame_move_ref(frame, item.get());
+    return true;
+}
+
+auto video_reader::pipeline::get_stats() const -> pipeline_stats
+{
+    return pipeline_stats{_demux.get(), _decode.get(), _convert.get()};
+}
+
+auto video_reader::pipeline::get_skipped_frame_count() const -> uint64_t
+{
+    return _skipped_frames;
+}
+
+stage_stats video_reader::pipeline::stage_counters::get() const
+{
+    return stage_stats{std::chrono::nanoseconds(busy_ns.load()), std::chrono::nanoseconds(idle_ns.load()), items.load()};
+}
+
+}
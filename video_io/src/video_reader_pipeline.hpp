@@ -0,0 +1,172 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/video_reader.hpp>
+
+#include <teiacare/video_io/concurrent_queue.hpp>
+
+#include "bounded_queue.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tc::vio
+{
+// Free list of AVPacket/AVFrame shells shared by the pipeline stages: released items are unreferenced and handed out again,
+// so that no allocation happens per packet or frame once the queues are full
+template <typename T, T* (*alloc)(), void (*unref)(T*), void (*destroy)(T**)>
+class shell_pool
+{
+public:
+    shell_pool() = default;
+    shell_pool(const shell_pool&) = delete;
+    shell_pool& operator=(const shell_pool&) = delete;
+
+    ~shell_pool()
+    {
+        for (T* item : _items)
+            destroy(&item);
+    }
+
+    T* acquire()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            if (!_items.empty())
+            {
+                T* item = _items.back();
+                _items.pop_back();
+                return item;
+            }
+        }
+
+        return alloc();
+    }
+
+    void release(T* item)
+    {
+        unref(item);
+
+        std::lock_guard lock(_mutex);
+        _items.push_back(item);
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<T*> _items;
+};
+
+using packet_shell_pool = shell_pool<AVPacket, av_packet_alloc, av_packet_unref, av_packet_free>;
+using frame_shell_pool = shell_pool<AVFrame, av_frame_alloc, av_frame_unref, av_frame_free>;
+
+// Items go back to their pool when released, if they have one
+struct packet_deleter
+{
+    packet_shell_pool* pool = nullptr;
+
+    void operator()(AVPacket* p) const
+    {
+        if (pool)
+            pool->release(p);
+        else
+            av_packet_free(&p);
+    }
+};
+
+struct frame_deleter
+{
+    frame_shell_pool* pool = nullptr;
+
+    void operator()(AVFrame* f) const
+    {
+        if (pool)
+            pool->release(f);
+        else
+            av_frame_free(&f);
+    }
+};
+
+using packet_ptr = std::unique_ptr<AVPacket, packet_deleter>;
+using frame_ptr = std::unique_ptr<AVFrame, frame_deleter>;
+
+// Demux, decode and convert stages of video_reader, each one on its own thread.
+// Stages are connected by lock-free single producer, single consumer queues and a null item marks the end of the stream.
+// The caller's thread only pops converted frames, which already have the output format and size.
+// With decode_options::latest_frame there is no conversion thread: a single slot keeps the newest decoded frame,
+// which the caller's thread pops and converts, so frames decoded while the caller is busy are never converted.
+struct video_reader::pipeline
+{
+    explicit pipeline(video_reader& reader, int depth);
+    ~pipeline();
+
+    void start();
+    void stop();
+    bool is_running() const;
+
+    int pop_packet(AVPacket* packet);
+    bool pop_frame(AVFrame* frame);
+    auto get_stats() const -> pipeline_stats;
+    auto get_skipped_frame_count() const -> uint64_t;
+
+private:
+    struct stage_counters
+    {
+        std::atomic<int64_t> busy_ns{0};
+        std::atomic<int64_t> idle_ns{0};
+        std::atomic<uint64_t> items{0};
+
+        stage_stats get() const;
+    };
+
+    void demux_loop();
+    void decode_loop();
+    void convert_loop();
+    frame_ptr convert(frame_ptr src);
+    packet_ptr alloc_packet();
+    frame_ptr alloc_frame();
+
+    video_reader& _reader;
+    packet_shell_pool _packet_shells; // declared before the queues, which return their items on destruction
+    frame_shell_pool _frame_shells;
+    spsc_queue<packet_ptr> _packets;
+    spsc_queue<frame_ptr> _decoded_frames;
+    spsc_queue<frame_ptr> _converted_frames;
+    bounded_queue<frame_ptr> _latest_frame; // the decoding thread replaces the frame the caller has not popped yet
+    bool _is_running;
+    bool _is_latest_frame;
+    SwsContext* _sws_ctx;
+    std::atomic<uint64_t> _skipped_frames;
+
+    stage_counters _demux;
+    stage_counters _decode;
+    stage_counters _convert;
+
+    std::thread _demux_thread;
+    std::thread _decode_thread;
+    std::thread _convert_thread;
+};
+
+}
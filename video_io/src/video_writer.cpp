@@ -31,6 +31,8 @@ extern "C"
 #include <libswscale/swscale.h>
 }
 
+#include <algorithm>
+
 namespace tc::vio
 {
 video_writer::video_writer() noexcept
@@ -59,6 +61,10 @@ void video_writer::init()
     _stream = nullptr;
     _stream_duration = -1;
     _next_pts = 0;
+
+    _is_stream_copy = false;
+    _start_timestamp = AV_NOPTS_VALUE;
+    _last_dts = AV_NOPTS_VALUE;
 }
 
 bool video_writer::open(const std::string& video_path, int width, int height, const int fps)
@@ -73,16 +79,8 @@ bool video_writer::open(const std::string& video_path, int width, int height, co
 
     log_info("Opening video path:", video_path, "width:", width, "height:", height, "fps:", fps);
 
-    if (auto r = avformat_alloc_output_context2(&_format_ctx, nullptr, nullptr, video_path.c_str()); r < 0)
-    {
-        log_error("Could not deduce output format from file extension: using MPEG", vio::logger::get().err2str(r));
-
-        if (auto r_mp4 = avformat_alloc_output_context2(&_format_ctx, nullptr, "mp4", video_path.c_str()); r_mp4 < 0)
-        {
-            log_error("avformat_alloc_output_context2", vio::logger::get().err2str(r_mp4));
-            return false;
-        }
-    }
+    if (!open_output(video_path))
+        return false;
 
     const AVCodec* codec = avcodec_find_encoder(_format_ctx->oformat->video_codec);
     if (!codec)
@@ -161,20 +159,8 @@ bool video_writer::open(const std::string& video_path, int width, int height, co
         return false;
     }
 
-    if (!(_format_ctx->oformat->flags & AVFMT_NOFILE))
-    {
-        if (auto r = avio_open(&_format_ctx->pb, video_path.c_str(), AVIO_FLAG_WRITE); r < 0)
-        {
-            log_error("avio_open", vio::logger::get().err2str(r));
-            return false;
-        }
-    }
-
-    if (auto r = avformat_write_header(_format_ctx, nullptr); r < 0)
-    {
-        log_error("avformat_write_header", vio::logger::get().err2str(r));
+    if (!write_header(video_path))
         return false;
-    }
 
     log_info("Video Writer is opened correctly");
     return true;
@@ -192,9 +178,97 @@ bool video_writer::open(const std::string& video_path, int width, int height, co
     return open(video_path, width, height, fps);
 }
 
+bool video_writer::open(const std::string& video_path, const codec_parameters& parameters)
+{
+    if (!parameters.is_valid())
+    {
+        log_error("open: invalid codec parameters");
+        return false;
+    }
+
+    release();
+
+    log_info("Opening video path:", video_path, "stream copy of:", parameters.codec_name());
+
+    if (!open_output(video_path))
+        return false;
+
+    if (_stream = avformat_new_stream(_format_ctx, nullptr); !_stream)
+    {
+        log_error("avformat_new_stream");
+        return false;
+    }
+    _stream->id = _format_ctx->nb_streams - 1;
+
+    // The extradata becomes the global header of MP4/MKV (e.g. H.264 SPS/PPS). When the input has none
+    // (e.g. RTSP without sprop-parameter-sets), the MP4 muxer takes it from the first keyframe, which is always the first packet written.
+    if (auto r = avcodec_parameters_copy(_stream->codecpar, parameters._parameters); r < 0)
+    {
+        log_error("avcodec_parameters_copy", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    // The codec tag of the input container may not be valid in the output one: let the muxer pick its own
+    _stream->codecpar->codec_tag = 0;
+    _stream->time_base = AVRational{parameters._time_base_num, parameters._time_base_den}; // Only a hint: the muxer may pick another one
+
+    if (_packet = av_packet_alloc(); !_packet)
+    {
+        log_error("av_packet_alloc");
+        return false;
+    }
+
+    if (!write_header(video_path))
+        return false;
+
+    _is_stream_copy = true;
+
+    log_info("Video Writer is opened correctly (stream copy)");
+    return true;
+}
+
+bool video_writer::open_output(const std::string& video_path)
+{
+    // Network outputs have no file extension to deduce the format from
+    const char* format_name = video_path.starts_with("rtsp://") ? "rtsp" : nullptr;
+
+    if (auto r = avformat_alloc_output_context2(&_format_ctx, nullptr, format_name, video_path.c_str()); r < 0)
+    {
+        log_error("Could not deduce output format from file extension: using MPEG", vio::logger::get().err2str(r));
+
+        if (auto r_mp4 = avformat_alloc_output_context2(&_format_ctx, nullptr, "mp4", video_path.c_str()); r_mp4 < 0)
+        {
+            log_error("avformat_alloc_output_context2", vio::logger::get().err2str(r_mp4));
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool video_writer::write_header(const std::string& video_path)
+{
+    if (!(_format_ctx->oformat->flags & AVFMT_NOFILE))
+    {
+        if (auto r = avio_open(&_format_ctx->pb, video_path.c_str(), AVIO_FLAG_WRITE); r < 0)
+        {
+            log_error("avio_open", vio::logger::get().err2str(r));
+            return false;
+        }
+    }
+
+    if (auto r = avformat_write_header(_format_ctx, nullptr); r < 0)
+    {
+        log_error("avformat_write_header", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    return true;
+}
+
 bool video_writer::is_opened() const
 {
-    return _codec_ctx != nullptr && _format_ctx != nullptr;
+    return _format_ctx != nullptr && (_codec_ctx != nullptr || _is_stream_copy);
 }
 
 AVFrame* video_writer::alloc_frame(int pix_fmt, int width, int height)
@@ -311,7 +385,7 @@ bool video_writer::convert(const uint8_t* data)
 
 bool video_writer::write(const uint8_t* data)
 {
-    if (!is_opened())
+    if (!is_opened() || _is_stream_copy)
         return false;
 
     if (!convert(data))
@@ -323,12 +397,88 @@ bool video_writer::write(const uint8_t* data)
     return true;
 }
 
+bool video_writer::write_packet(const packet& p)
+{
+    if (!is_opened() || !_is_stream_copy)
+    {
+        log_error("write_packet: the video writer must be opened with codec parameters");
+        return false;
+    }
+
+    if (!p.is_valid() || p._packet->time_base.num <= 0 || p._packet->time_base.den <= 0)
+    {
+        log_error("write_packet: invalid packet");
+        return false;
+    }
+
+    // A recording can only be decoded from a keyframe: the packets before the first one are dropped
+    if (_start_timestamp == AV_NOPTS_VALUE && !p.is_keyframe())
+        return true;
+
+    if (auto r = av_packet_ref(_packet, p._packet); r < 0)
+    {
+        log_error("av_packet_ref", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    if (_packet->pts == AV_NOPTS_VALUE)
+        _packet->pts = _packet->dts;
+
+    if (_packet->dts == AV_NOPTS_VALUE)
+        _packet->dts = _packet->pts;
+
+    if (_packet->dts == AV_NOPTS_VALUE)
+    {
+        log_info("write_packet: packet without timestamps dropped");
+        av_packet_unref(_packet);
+        return true;
+    }
+
+    // The recording starts from 0 whatever the input starts from (e.g. the wall clock of a live stream)
+    av_packet_rescale_ts(_packet, _packet->time_base, _stream->time_base);
+    if (_start_timestamp == AV_NOPTS_VALUE)
+        _start_timestamp = _packet->dts;
+
+    // After a reconnection the input timestamps start over: the recording continues right after the last packet written
+    if (p.is_discontinuity() && _last_dts != AV_NOPTS_VALUE)
+    {
+        _start_timestamp = _packet->dts - (_last_dts + std::max<int64_t>(_packet->duration, 1));
+        log_info("write_packet: input timestamps restarted");
+    }
+
+    _packet->pts -= _start_timestamp;
+    _packet->dts -= _start_timestamp;
+
+    // Muxers reject non increasing timestamps (e.g. after a glitch of a live stream, or after the rescaling rounded two of them together)
+    if (_last_dts != AV_NOPTS_VALUE && _packet->dts <= _last_dts)
+    {
+        log_info("write_packet: non increasing dts, packet dropped:", _packet->dts);
+        av_packet_unref(_packet);
+        return true;
+    }
+
+    _last_dts = _packet->dts;
+    _packet->stream_index = _stream->index;
+    _packet->time_base = _stream->time_base;
+    _packet->pos = -1;
+
+    // av_interleaved_write_frame() takes ownership of the contents of _packet and resets it
+    if (auto r = av_interleaved_write_frame(_format_ctx, _packet); r < 0)
+    {
+        log_error("av_interleaved_write_frame", vio::logger::get().err2str(r));
+        return false;
+    }
+
+    return true;
+}
+
 bool video_writer::save()
 {
     if (!is_opened())
         return false;
 
-    encode(nullptr);
+    if (_codec_ctx)
+        encode(nullptr);
 
     if (auto r = av_write_trailer(_format_ctx); r < 0)
     {
@@ -396,11 +546,7 @@ bool video_writer::check(const std::string& video_path)
         return false;
     }
 
-#if LIBAVCODEC_VERSION_MAJOR <= 58
-    AVCodec* codec = nullptr;
-#elif LIBAVCODEC_VERSION_MAJOR >= 59
     const AVCodec* codec = nullptr;
-#endif
 
     int stream_index = av_find_best_stream(fmt_ctx, AVMediaType::AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
     if (stream_index < 0)
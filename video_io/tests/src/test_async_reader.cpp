@@ -0,0 +1,143 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_async_reader.hpp"
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace tc::vio::tests
+{
+
+TEST_F(async_reader_test, read_without_open)
+{
+    vio::frame f;
+    ASSERT_FALSE(r->is_opened());
+    ASSERT_FALSE(r->try_read(f));
+    ASSERT_FALSE(r->read(f));
+    ASSERT_FALSE(r->read_for(f, std::chrono::milliseconds(10)));
+    ASSERT_TRUE(r->is_end_of_stream());
+}
+
+TEST_F(async_reader_test, read_all_frames_in_order)
+{
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(default_video_path.string().c_str()));
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {}, {.capacity = 3}));
+    ASSERT_EQ(r->get_queue_capacity(), 3u);
+    ASSERT_EQ(r->get_frame_size(), v.get_frame_size());
+
+    vio::frame f;
+    vio::frame expected;
+    std::set<const uint8_t*> buffers;
+    for (int i = 0; i < total_frames; ++i)
+    {
+        ASSERT_TRUE(r->read(f));
+        ASSERT_LE(r->get_queue_size(), 3u);
+        ASSERT_TRUE(v.read(expected));
+        ASSERT_EQ(f.pts(), expected.pts());
+        ASSERT_EQ(f.size_in_bytes(), expected.size_in_bytes());
+        ASSERT_EQ(std::memcmp(f.data(), expected.data(), f.size_in_bytes()), 0);
+        buffers.insert(f.data());
+    }
+
+    // Buffers are recycled between the caller and the ring instead of being allocated for every frame
+    ASSERT_LE(buffers.size(), 3u + 2u);
+
+    ASSERT_FALSE(r->read(f));
+    ASSERT_FALSE(f.is_valid());
+    ASSERT_TRUE(r->is_end_of_stream());
+    ASSERT_EQ(r->get_dropped_frame_count(), 0u);
+}
+
+TEST_F(async_reader_test, overflow_drop_oldest)
+{
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {}, {.capacity = 2, .overflow = vio::overflow_policy::drop_oldest}));
+    ASSERT_TRUE(wait_for_dropped_frames(total_frames - 2));
+
+    // Only the two most recent frames are left
+    vio::frame f;
+    ASSERT_TRUE(r->read_for(f, std::chrono::seconds(1)));
+    ASSERT_NEAR(f.pts(), (total_frames - 2) / fps, 0.5 / fps);
+    ASSERT_TRUE(r->try_read(f));
+    ASSERT_NEAR(f.pts(), (total_frames - 1) / fps, 0.5 / fps);
+    ASSERT_FALSE(r->read(f));
+}
+
+TEST_F(async_reader_test, overflow_drop_newest)
+{
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {}, {.capacity = 2, .overflow = vio::overflow_policy::drop_newest}));
+    ASSERT_TRUE(wait_for_dropped_frames(total_frames - 2));
+
+    // Only the first two frames are kept
+    vio::frame f;
+    ASSERT_TRUE(r->read(f));
+    ASSERT_NEAR(f.pts(), 0.0, 0.5 / fps);
+    ASSERT_TRUE(r->read(f));
+    ASSERT_NEAR(f.pts(), 1.0 / fps, 0.5 / fps);
+    ASSERT_FALSE(r->read(f));
+}
+
+TEST_F(async_reader_test, release_while_decoding)
+{
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {}, {.capacity = 1}));
+
+    vio::frame f;
+    ASSERT_TRUE(r->read(f));
+    r->release();
+    ASSERT_FALSE(r->is_opened());
+    ASSERT_FALSE(r->try_read(f));
+
+    // Reopen the same reader
+    ASSERT_TRUE(r->open(default_video_path.string().c_str()));
+    ASSERT_TRUE(r->read(f));
+    ASSERT_NEAR(f.pts(), 0.0, 0.5 / fps);
+}
+
+TEST_F(async_reader_test, open_with_input_options)
+{
+    // The input options reach the inner reader: the probed stream parameters land in the hint cache
+    auto cache = std::make_shared<vio::stream_hint_cache>();
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {}, {}, {.hint_cache = cache}));
+    ASSERT_TRUE(cache->find(default_video_path.string().c_str()).has_value());
+
+    vio::frame f;
+    ASSERT_TRUE(r->read(f));
+    ASSERT_NEAR(f.pts(), 0.0, 0.5 / fps);
+}
+
+TEST_F(async_reader_test, release_stalled_live_input)
+{
+    // After the only session, nobody pushes to the listening reader and the decoding thread keeps reconnecting: release() interrupts it
+    const std::string url = "rtsp://127.0.0.1:8555/async_stalled";
+    std::thread camera(utils::push_live_sessions, default_video_path, url, 1);
+
+    const bool is_opened = r->open(url.c_str(), vio::decode_support::SW, {}, {}, {.capacity = 2, .overflow = vio::overflow_policy::drop_oldest}, {.rtsp_listen = true, .open_timeout = std::chrono::seconds(2), .reconnect_attempts = -1});
+    camera.join();
+    ASSERT_TRUE(is_opened);
+
+    vio::frame f;
+    while (r->read_for(f, std::chrono::milliseconds(500)))
+    {
+    }
+    ASSERT_FALSE(f.is_valid());
+
+    const auto start = std::chrono::steady_clock::now();
+    r->release();
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    ASSERT_FALSE(r->is_opened());
+}
+
+}
@@ -0,0 +1,62 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/async_reader.hpp>
+
+#include "utils/live_source.hpp"
+#include "utils/video_data_path.hpp"
+#include <chrono>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+namespace tc::vio::tests
+{
+class async_reader_test : public testing::Test
+{
+protected:
+    explicit async_reader_test()
+        : r{std::make_unique<vio::async_reader>()}
+        , default_video_path{std::filesystem::path(tc::vio::tests::utils::video_data_path) / "video_10sec_4fps_HD.mp4"}
+    {
+    }
+
+    virtual ~async_reader_test()
+    {
+        r->release();
+    }
+
+    // Wait until the decoding thread has filled the queue and dropped all the frames that did not fit
+    bool wait_for_dropped_frames(uint64_t dropped_frames) const
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (r->get_dropped_frame_count() < dropped_frames)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    std::unique_ptr<vio::async_reader> r;
+    const std::filesystem::path default_video_path;
+    static constexpr int total_frames = 40;
+    static constexpr double fps = 4.0;
+};
+
+}
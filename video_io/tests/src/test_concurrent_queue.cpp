@@ -0,0 +1,175 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_concurrent_queue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace tc::vio::tests
+{
+
+TYPED_TEST(concurrent_queue_test, fifo_until_full)
+{
+    auto& q = *this->q;
+    ASSERT_EQ(q.capacity(), 8u);
+
+    for (int i = 0; i < 8; ++i)
+        ASSERT_TRUE(q.try_push(std::make_unique<int>(i)));
+
+    // A failed push does not consume the item
+    auto item = std::make_unique<int>(8);
+    ASSERT_FALSE(q.try_push(std::move(item)));
+    ASSERT_NE(item, nullptr);
+    ASSERT_EQ(q.size(), 8u);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        ASSERT_TRUE(q.try_pop(item));
+        ASSERT_EQ(*item, i);
+    }
+    ASSERT_FALSE(q.try_pop(item));
+    ASSERT_EQ(q.size(), 0u);
+
+    // Wrap around the ring
+    for (int i = 0; i < 20; ++i)
+    {
+        ASSERT_TRUE(q.try_push(std::make_unique<int>(i)));
+        ASSERT_TRUE(q.try_pop(item));
+        ASSERT_EQ(*item, i);
+    }
+}
+
+TYPED_TEST(concurrent_queue_test, close_wakes_up_waiting_threads)
+{
+    auto& q = *this->q;
+
+    std::unique_ptr<int> item;
+    std::thread consumer([&] { ASSERT_FALSE(q.pop(item)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    q.close();
+    consumer.join();
+
+    ASSERT_TRUE(q.is_closed());
+    ASSERT_FALSE(q.push(std::make_unique<int>(0)));
+    ASSERT_FALSE(q.try_push(std::make_unique<int>(0)));
+}
+
+TYPED_TEST(concurrent_queue_test, pop_remaining_items_after_close)
+{
+    auto& q = *this->q;
+    ASSERT_TRUE(q.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(q.push(std::make_unique<int>(2)));
+    q.close();
+
+    std::unique_ptr<int> item;
+    ASSERT_TRUE(q.pop(item));
+    ASSERT_EQ(*item, 1);
+    ASSERT_TRUE(q.pop(item));
+    ASSERT_EQ(*item, 2);
+    ASSERT_FALSE(q.pop(item));
+}
+
+TYPED_TEST(concurrent_queue_test, reset_after_close)
+{
+    auto& q = *this->q;
+    ASSERT_TRUE(q.push(std::make_unique<int>(1)));
+    ASSERT_TRUE(q.push(std::make_unique<int>(2)));
+    q.close();
+
+    // Queued items are dropped and the queue is open again, from an empty ring
+    q.reset();
+    ASSERT_FALSE(q.is_closed());
+    ASSERT_EQ(q.size(), 0u);
+
+    std::unique_ptr<int> item;
+    ASSERT_FALSE(q.try_pop(item));
+    for (int i = 0; i < 8; ++i)
+        ASSERT_TRUE(q.try_push(std::make_unique<int>(i)));
+    ASSERT_FALSE(q.try_push(std::make_unique<int>(8)));
+
+    ASSERT_TRUE(q.pop(item));
+    ASSERT_EQ(*item, 0);
+}
+
+TYPED_TEST(concurrent_queue_test, blocking_transfer_in_order)
+{
+    auto& q = *this->q;
+    constexpr int item_count = 100000;
+
+    // The producer is much faster than the capacity, so both sides wait
+    std::thread producer(
+        [&]
+        {
+            for (int i = 0; i < item_count; ++i)
+                q.push(std::make_unique<int>(i));
+            q.close();
+        });
+
+    int expected = 0;
+    std::unique_ptr<int> item;
+    while (q.pop(item))
+    {
+        ASSERT_EQ(*item, expected);
+        ++expected;
+    }
+    producer.join();
+    ASSERT_EQ(expected, item_count);
+}
+
+TEST(mpmc_queue_test, many_producers_and_consumers)
+{
+    vio::mpmc_queue<int> q(16);
+    constexpr int producer_count = 4;
+    constexpr int consumer_count = 4;
+    constexpr int items_per_producer = 50000;
+
+    std::vector<std::atomic<int>> received(producer_count * items_per_producer);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < consumer_count; ++c)
+    {
+        consumers.emplace_back(
+            [&]
+            {
+                int item = 0;
+                while (q.pop(item))
+                    ++received[item];
+            });
+    }
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producer_count; ++p)
+    {
+        producers.emplace_back(
+            [&, p]
+            {
+                for (int i = 0; i < items_per_producer; ++i)
+                    q.push(p * items_per_producer + i);
+            });
+    }
+
+    for (auto& t : producers)
+        t.join();
+    q.close();
+    for (auto& t : consumers)
+        t.join();
+
+    // Every item is received exactly once
+    for (size_t i = 0; i < received.size(); ++i)
+        ASSERT_EQ(received[i], 1) << "item: " << i;
+}
+
+}
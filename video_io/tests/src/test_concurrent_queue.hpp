@@ -0,0 +1,40 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/concurrent_queue.hpp>
+
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace tc::vio::tests
+{
+template <typename Queue>
+class concurrent_queue_test : public testing::Test
+{
+protected:
+    explicit concurrent_queue_test()
+        : q{std::make_unique<Queue>(capacity)}
+    {
+    }
+
+    static constexpr size_t capacity = 6; // rounded up to 8
+    std::unique_ptr<Queue> q;
+};
+
+using queue_types = testing::Types<vio::spsc_queue<std::unique_ptr<int>>, vio::mpmc_queue<std::unique_ptr<int>>>;
+TYPED_TEST_SUITE(concurrent_queue_test, queue_types);
+
+}
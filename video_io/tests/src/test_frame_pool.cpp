@@ -0,0 +1,183 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_frame_pool.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace tc::vio::tests
+{
+
+TEST_F(frame_pool_test, get_frame)
+{
+    ASSERT_TRUE(pool->is_valid());
+    ASSERT_EQ(pool->get_high_water_mark(), 0u);
+
+    vio::frame f;
+    ASSERT_TRUE(pool->get(f));
+    ASSERT_TRUE(f.is_valid());
+    ASSERT_EQ(f.format(), vio::pixel_format::rgb24);
+    ASSERT_EQ(f.width(), width);
+    ASSERT_EQ(f.height(), height);
+    ASSERT_EQ(f.linesize() % vio::frame_pool::default_alignment, 0);
+    ASSERT_GE(f.linesize(), width * 3);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(f.data()) % vio::frame_pool::default_alignment, 0u);
+    ASSERT_GE(pool->get_buffer_size(), static_cast<size_t>(f.linesize()) * height);
+    ASSERT_EQ(pool->get_high_water_mark(), 1u);
+}
+
+TEST_F(frame_pool_test, planar_format)
+{
+    vio::frame_pool yuv_pool(vio::pixel_format::yuv420p, width, height, 32);
+    ASSERT_TRUE(yuv_pool.is_valid());
+
+    vio::frame f;
+    ASSERT_TRUE(yuv_pool.get(f));
+    ASSERT_EQ(f.planes(), 3);
+    for (int plane = 0; plane < f.planes(); ++plane)
+    {
+        ASSERT_EQ(f.linesize(plane) % 32, 0);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(f.data(plane)) % 32, 0u);
+    }
+}
+
+TEST_F(frame_pool_test, invalid_pool)
+{
+    vio::frame f;
+    ASSERT_FALSE(vio::frame_pool(vio::pixel_format::rgb24, width, height, 48).is_valid());
+    ASSERT_FALSE(vio::frame_pool(vio::pixel_format::rgb24, width, 0).is_valid());
+
+    vio::frame_pool invalid_pool(vio::pixel_format::native, width, height);
+    ASSERT_FALSE(invalid_pool.is_valid());
+    ASSERT_FALSE(invalid_pool.get(f));
+    ASSERT_FALSE(f.is_valid());
+}
+
+TEST_F(frame_pool_test, recycle_buffers)
+{
+    // Released buffers are handed out again instead of allocating new ones
+    vio::frame f;
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(pool->get(f));
+        f.release();
+    }
+    ASSERT_EQ(pool->get_high_water_mark(), 1u);
+
+    // Shared buffers are in use until every handle is released
+    std::vector<vio::frame> frames;
+    for (int i = 0; i < 4; ++i)
+    {
+        frames.emplace_back();
+        ASSERT_TRUE(pool->get(frames.back()));
+        frames.push_back(frames.back().share());
+    }
+    ASSERT_EQ(pool->get_high_water_mark(), 4u);
+
+    frames.clear();
+    for (int i = 0; i < 4; ++i)
+    {
+        frames.emplace_back();
+        ASSERT_TRUE(pool->get(frames.back()));
+    }
+    ASSERT_EQ(pool->get_high_water_mark(), 4u);
+}
+
+TEST_F(frame_pool_test, frames_outlive_pool)
+{
+    vio::frame f;
+    ASSERT_TRUE(pool->get(f));
+    pool.reset();
+
+    ASSERT_TRUE(f.is_valid());
+    vio::frame copy = f.copy();
+    ASSERT_TRUE(copy.is_valid());
+}
+
+TEST_F(frame_pool_test, shared_pool)
+{
+    auto a = vio::frame_pool::get_shared(vio::pixel_format::rgb24, width, height);
+    auto b = vio::frame_pool::get_shared(vio::pixel_format::rgb24, width, height);
+    ASSERT_EQ(a, b);
+    ASSERT_NE(a, vio::frame_pool::get_shared(vio::pixel_format::bgr24, width, height));
+    ASSERT_NE(a, vio::frame_pool::get_shared(vio::pixel_format::rgb24, width, height + 2));
+    ASSERT_NE(a, vio::frame_pool::get_shared(vio::pixel_format::rgb24, width, height, 32));
+}
+
+TEST_F(frame_pool_test, reader_steady_state)
+{
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(default_video_path.string().c_str()));
+    auto reader_pool = v.get_frame_pool();
+    ASSERT_NE(reader_pool, nullptr);
+
+    // Holding the last frames read: one more buffer is enough to decode the next one
+    constexpr size_t held_frames = 3;
+    std::deque<vio::frame> frames;
+    for (int i = 0; i < 300; ++i)
+    {
+        vio::frame f;
+        ASSERT_TRUE(v.read(f));
+        frames.push_back(std::move(f));
+        if (frames.size() > held_frames)
+            frames.pop_front();
+    }
+
+    ASSERT_EQ(reader_pool->get_high_water_mark(), held_frames + 1);
+}
+
+TEST_F(frame_pool_test, readers_share_pool)
+{
+    vio::video_reader a;
+    vio::video_reader b;
+    vio::video_reader c;
+    ASSERT_TRUE(a.open(default_video_path.string().c_str()));
+    ASSERT_TRUE(b.open(default_video_path.string().c_str()));
+    ASSERT_TRUE(c.open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.format = vio::pixel_format::gray8}));
+    ASSERT_EQ(a.get_frame_pool(), b.get_frame_pool());
+    ASSERT_NE(a.get_frame_pool(), c.get_frame_pool());
+
+    // Frames are recycled by either reader
+    vio::frame f;
+    for (int i = 0; i < 50; ++i)
+    {
+        ASSERT_TRUE(a.read(f));
+        ASSERT_TRUE(b.read(f));
+    }
+    ASSERT_LE(a.get_frame_pool()->get_high_water_mark(), 3u);
+}
+
+TEST_F(frame_pool_test, reader_custom_pool)
+{
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.format = vio::pixel_format::bgr24, .width = 320, .height = 240}));
+
+    // A pool with another format or size is ignored
+    auto custom_pool = std::make_shared<vio::frame_pool>(vio::pixel_format::bgr24, 320, 240);
+    ASSERT_TRUE(v.open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.format = vio::pixel_format::gray8, .pool = custom_pool}));
+    ASSERT_NE(v.get_frame_pool(), custom_pool);
+
+    ASSERT_TRUE(v.open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.format = vio::pixel_format::bgr24, .width = 320, .height = 240, .pool = custom_pool}));
+    ASSERT_EQ(v.get_frame_pool(), custom_pool);
+
+    vio::frame f;
+    ASSERT_TRUE(v.read(f));
+    ASSERT_EQ(f.width(), 320);
+    ASSERT_EQ(f.linesize() % custom_pool->alignment(), 0);
+    ASSERT_EQ(custom_pool->get_high_water_mark(), 1u);
+}
+
+}
@@ -0,0 +1,42 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/frame_pool.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace tc::vio::tests
+{
+class frame_pool_test : public testing::Test
+{
+protected:
+    explicit frame_pool_test()
+        : pool{std::make_unique<vio::frame_pool>(vio::pixel_format::rgb24, width, height)}
+        , default_video_path{std::filesystem::path(tc::vio::tests::utils::video_data_path) / "video_120sec_30fps_SD.mp4"}
+    {
+    }
+
+    static constexpr int width = 642; // rows are padded to the alignment
+    static constexpr int height = 480;
+    std::unique_ptr<vio::frame_pool> pool;
+    const std::filesystem::path default_video_path;
+};
+
+}
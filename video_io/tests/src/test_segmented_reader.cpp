@@ -0,0 +1,154 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_segmented_reader.hpp"
+
+#include <teiacare/video_io/video_index.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace tc::vio::tests
+{
+
+TEST_F(segmented_reader_test, read_without_open)
+{
+    vio::frame f;
+    int frame_index = 0;
+    ASSERT_FALSE(r->is_opened());
+    ASSERT_FALSE(r->read(f, &frame_index));
+    ASSERT_EQ(frame_index, -1);
+    ASSERT_FALSE(r->get_frame_count().has_value());
+    ASSERT_EQ(r->get_segment_count(), 0u);
+}
+
+TEST_F(segmented_reader_test, read_ordered)
+{
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.worker_count = 4}));
+    ASSERT_EQ(r->get_frame_count().value(), total_frames);
+    ASSERT_GT(r->get_segment_count(), 1u);
+    ASSERT_EQ(r->get_worker_count(), 4u);
+
+    // Same frames, in the same order, as a single sequential reader
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(default_video_path.string().c_str()));
+    ASSERT_EQ(r->get_frame_size(), v.get_frame_size());
+
+    vio::frame f;
+    vio::frame expected;
+    int frame_index = -1;
+    for (int i = 0; i < total_frames; ++i)
+    {
+        ASSERT_TRUE(r->read(f, &frame_index));
+        ASSERT_EQ(frame_index, i);
+        ASSERT_TRUE(v.read(expected));
+        ASSERT_EQ(f.pts(), expected.pts());
+        ASSERT_EQ(f.size_in_bytes(), expected.size_in_bytes());
+        ASSERT_EQ(std::memcmp(f.data(), expected.data(), f.size_in_bytes()), 0);
+    }
+
+    ASSERT_FALSE(r->read(f, &frame_index));
+    ASSERT_FALSE(f.is_valid());
+    ASSERT_EQ(frame_index, -1);
+    ASSERT_FALSE(r->has_error());
+}
+
+TEST_F(segmented_reader_test, read_unordered)
+{
+    vio::video_index index;
+    ASSERT_TRUE(index.build(default_video_path.string().c_str()));
+    const auto [time_base_num, time_base_den] = index.get_time_base();
+
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {.format = vio::pixel_format::gray8}, {.worker_count = 4, .ordered = false}));
+
+    // Every frame is returned exactly once, tagged with its position in presentation order
+    vio::frame f;
+    int frame_index = -1;
+    std::vector<int> read_count(total_frames, 0);
+    while (r->read(f, &frame_index))
+    {
+        ASSERT_GE(frame_index, 0);
+        ASSERT_LT(frame_index, total_frames);
+        ++read_count[frame_index];
+
+        const double expected_pts = static_cast<double>(index.get_frame_timestamp(frame_index).value()) * time_base_num / time_base_den;
+        ASSERT_NEAR(f.pts(), expected_pts, 0.5 / fps);
+    }
+
+    for (int i = 0; i < total_frames; ++i)
+        ASSERT_EQ(read_count[i], 1) << "frame index: " << i;
+    ASSERT_FALSE(r->has_error());
+}
+
+TEST_F(segmented_reader_test, read_ordered_bounded_memory)
+{
+    constexpr int worker_count = 4;
+    constexpr int segment_queue_size = 2;
+    constexpr int window_segments = 3;
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.worker_count = worker_count, .min_segment_frames = 1, .segment_queue_size = segment_queue_size, .window_segments = window_segments}));
+
+    // Workers wait in the middle of a segment while the caller is slow: frames are still returned in order
+    vio::frame f;
+    int frame_index = -1;
+    for (int i = 0; i < total_frames; ++i)
+    {
+        ASSERT_TRUE(r->read(f, &frame_index));
+        ASSERT_EQ(frame_index, i);
+        if (i % 100 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    ASSERT_FALSE(r->read(f, &frame_index));
+
+    // Queued frames in the window, plus the frame every worker holds while waiting for space
+    ASSERT_GT(r->get_peak_queued_frames(), 0u);
+    ASSERT_LE(r->get_peak_queued_frames(), static_cast<size_t>(window_segments * segment_queue_size + worker_count));
+}
+
+TEST_F(segmented_reader_test, read_ordered_default_memory_bound)
+{
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.worker_count = 4}));
+
+    vio::frame f;
+    int read_count = 0;
+    while (r->read(f))
+        ++read_count;
+    ASSERT_EQ(read_count, total_frames);
+
+    // Defaults: window of twice the workers, 8 frames per segment, far less than a whole segment per worker
+    const vio::segmented_options defaults;
+    const size_t bound = 2 * r->get_worker_count() * static_cast<size_t>(defaults.segment_queue_size) + r->get_worker_count();
+    ASSERT_LE(r->get_peak_queued_frames(), bound);
+}
+
+TEST_F(segmented_reader_test, release_while_decoding)
+{
+    ASSERT_TRUE(r->open(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.worker_count = 2, .min_segment_frames = 1}));
+
+    vio::frame f;
+    ASSERT_TRUE(r->read(f));
+    r->release();
+    ASSERT_FALSE(r->is_opened());
+    ASSERT_FALSE(r->read(f));
+
+    // Reopen the same reader
+    int frame_index = -1;
+    ASSERT_TRUE(r->open(default_video_path.string().c_str()));
+    ASSERT_TRUE(r->read(f, &frame_index));
+    ASSERT_EQ(frame_index, 0);
+    ASSERT_NEAR(f.pts(), 0.0, 0.5 / fps);
+}
+
+}
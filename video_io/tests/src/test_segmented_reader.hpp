@@ -0,0 +1,46 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/segmented_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace tc::vio::tests
+{
+class segmented_reader_test : public testing::Test
+{
+protected:
+    explicit segmented_reader_test()
+        : r{std::make_unique<vio::segmented_reader>()}
+        , default_video_path{std::filesystem::path(tc::vio::tests::utils::video_data_path) / "video_120sec_30fps_SD.mp4"}
+    {
+    }
+
+    virtual ~segmented_reader_test()
+    {
+        r->release();
+    }
+
+    std::unique_ptr<vio::segmented_reader> r;
+    const std::filesystem::path default_video_path;
+    static constexpr int total_frames = 3600;
+    static constexpr double fps = 30.0;
+};
+
+}
@@ -0,0 +1,197 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_stream_hint.hpp"
+
+#include <teiacare/video_io/video_writer.hpp>
+
+#include <chrono>
+#include <fstream>
+
+namespace tc::vio::tests
+{
+
+TEST_F(stream_hint_test, open_without_probing)
+{
+    for (const auto* video_name : {"video_10sec_4fps_HD.mp4", "video_10sec_4fps_HD.mkv"})
+    {
+        const auto path = video_path(video_name);
+
+        vio::video_reader probed;
+        ASSERT_TRUE(probed.open(path.c_str(), decode_support::SW, {}, {}, {.hint_cache = cache}));
+        ASSERT_TRUE(probed.is_probed());
+        ASSERT_TRUE(cache->find(path.c_str()).has_value());
+
+        // The second open takes the stream parameters from the cache, and reads the same frames
+        vio::video_reader hinted;
+        ASSERT_TRUE(hinted.open(path.c_str(), decode_support::SW, {}, {}, {.hint_cache = cache}));
+        ASSERT_FALSE(hinted.is_probed());
+        ASSERT_EQ(hinted.get_frame_size(), probed.get_frame_size());
+        ASSERT_DOUBLE_EQ(hinted.get_fps().value(), probed.get_fps().value());
+        ASSERT_EQ(hinted.get_frame_count(), probed.get_frame_count());
+        ASSERT_NEAR(std::chrono::duration<double>(hinted.get_duration().value()).count(), std::chrono::duration<double>(probed.get_duration().value()).count(), 0.001);
+        expect_same_hint(hinted.get_stream_hint().value(), probed.get_stream_hint().value());
+
+        vio::frame expected;
+        vio::frame f;
+        int frame_count = 0;
+        while (probed.read(expected))
+        {
+            ASSERT_TRUE(hinted.read(f));
+            ASSERT_EQ(f.size_in_bytes(), expected.size_in_bytes());
+            ASSERT_DOUBLE_EQ(f.pts(), expected.pts());
+            ++frame_count;
+        }
+        ASSERT_FALSE(hinted.read(f));
+        ASSERT_EQ(frame_count, 40);
+    }
+
+    ASSERT_EQ(cache->size(), 2U);
+}
+
+TEST_F(stream_hint_test, wrong_hint_falls_back_to_probing)
+{
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(video_path("video_10sec_4fps_FHD.mp4").c_str()));
+    const auto fhd_hint = v.get_stream_hint();
+    ASSERT_TRUE(fhd_hint.has_value());
+
+    // The container header of the HD file does not match the size of the hint
+    ASSERT_TRUE(v.open(video_path("video_10sec_4fps_HD.mp4").c_str(), decode_support::SW, {}, {}, {.hint = fhd_hint}));
+    ASSERT_TRUE(v.is_probed());
+    ASSERT_EQ(v.get_frame_size(), std::make_tuple(1280, 720));
+
+    // Neither does the container format
+    auto mkv_hint = *fhd_hint;
+    mkv_hint.format_name = "matroska";
+    ASSERT_TRUE(v.open(video_path("video_10sec_4fps_FHD.mp4").c_str(), decode_support::SW, {}, {}, {.hint = mkv_hint}));
+    ASSERT_TRUE(v.is_probed());
+
+    vio::frame f;
+    ASSERT_TRUE(v.read(f));
+    ASSERT_EQ(f.width(), 1920);
+}
+
+TEST_F(stream_hint_test, raw_stream_hint_checked_on_first_frame)
+{
+    // Raw H.264 elementary stream: its header has no frame size to check a hint against
+    const auto path = (output_directory / "video.h264").string();
+    {
+        vio::video_reader source;
+        ASSERT_TRUE(source.open(video_path("video_10sec_4fps_HD.mp4").c_str(), decode_support::SW, {.annexb = true}));
+        vio::video_writer writer;
+        ASSERT_TRUE(writer.open(path, source.get_codec_parameters().value()));
+
+        vio::packet p;
+        while (source.read_packet(p))
+            ASSERT_TRUE(writer.write_packet(p));
+        writer.save();
+    }
+
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(path.c_str()));
+    ASSERT_TRUE(v.is_probed());
+    const auto hint = v.get_stream_hint();
+    ASSERT_TRUE(hint.has_value());
+    ASSERT_EQ(hint->format_name, "h264");
+
+    // A matching hint skips the probing, and the first frame (decoded to check it) is not lost
+    ASSERT_TRUE(v.open(path.c_str(), decode_support::SW, {}, {}, {.hint = hint}));
+    ASSERT_FALSE(v.is_probed());
+    vio::frame f;
+    int frame_count = 0;
+    while (v.read(f))
+    {
+        ASSERT_EQ(f.width(), 1280);
+        ++frame_count;
+    }
+    ASSERT_EQ(frame_count, 40);
+
+    // A hint with the right format and codec but the wrong size is rejected by the first frame
+    auto wrong_hint = *hint;
+    wrong_hint.width = 1920;
+    wrong_hint.height = 1080;
+    ASSERT_TRUE(cache->insert(path.c_str(), wrong_hint));
+    ASSERT_TRUE(v.open(path.c_str(), decode_support::SW, {}, {}, {.hint_cache = cache}));
+    ASSERT_TRUE(v.is_probed());
+    ASSERT_EQ(v.get_frame_size(), std::make_tuple(1280, 720));
+    ASSERT_TRUE(v.read(f));
+    ASSERT_EQ(f.width(), 1280);
+    ASSERT_EQ(cache->find(path.c_str())->width, 1280);
+
+    // video_info does not decode: it never takes a hint it cannot check
+    ASSERT_TRUE(cache->insert(path.c_str(), wrong_hint));
+    vio::video_info info;
+    const auto metadata = info.get_video_metadata(path, cache);
+    ASSERT_TRUE(metadata.has_value());
+    ASSERT_EQ(metadata->width, 1280);
+    ASSERT_EQ(metadata->height, 720);
+}
+
+TEST_F(stream_hint_test, cache_invalidated_by_file_change)
+{
+    const auto path = output_directory / "video.mp4";
+    std::filesystem::copy_file(video_path("video_10sec_4fps_HD.mp4"), path);
+
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(path.string().c_str(), decode_support::SW, {}, {}, {.hint_cache = cache}));
+    ASSERT_TRUE(cache->find(path.string().c_str()).has_value());
+    v.release();
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file.put(0);
+    }
+    ASSERT_FALSE(cache->find(path.string().c_str()).has_value());
+
+    cache->erase(path.string().c_str());
+    ASSERT_EQ(cache->size(), 0U);
+    ASSERT_FALSE(cache->insert((output_directory / "missing.mp4").string().c_str(), {}));
+}
+
+TEST_F(stream_hint_test, save_load)
+{
+    const auto path = video_path("video_10sec_4fps_HD.mp4");
+    vio::video_info info;
+    const auto probed_metadata = info.get_video_metadata(path, cache);
+    ASSERT_TRUE(probed_metadata.has_value());
+    ASSERT_EQ(cache->size(), 1U);
+
+    const auto cache_path = (output_directory / "hints.txt").string();
+    ASSERT_TRUE(cache->save(cache_path.c_str()));
+
+    auto loaded = std::make_shared<vio::stream_hint_cache>();
+    ASSERT_TRUE(loaded->load(cache_path.c_str()));
+    ASSERT_EQ(loaded->size(), 1U);
+    expect_same_hint(loaded->find(path.c_str()).value(), cache->find(path.c_str()).value());
+
+    // video_info gives the same metadata with the loaded hint
+    const auto hinted_metadata = info.get_video_metadata(path, loaded);
+    ASSERT_TRUE(hinted_metadata.has_value());
+    EXPECT_EQ(hinted_metadata->width, probed_metadata->width);
+    EXPECT_EQ(hinted_metadata->height, probed_metadata->height);
+    EXPECT_EQ(hinted_metadata->nb_frames, probed_metadata->nb_frames);
+    EXPECT_DOUBLE_EQ(hinted_metadata->avg_frame_rate, probed_metadata->avg_frame_rate);
+    EXPECT_NEAR(hinted_metadata->duration, probed_metadata->duration, 0.001);
+
+    ASSERT_FALSE(loaded->load((output_directory / "missing.txt").string().c_str()));
+    {
+        std::ofstream file(cache_path, std::ios::trunc);
+        file << "not a cache\n";
+    }
+    ASSERT_FALSE(loaded->load(cache_path.c_str()));
+    ASSERT_EQ(loaded->size(), 1U);
+}
+
+}
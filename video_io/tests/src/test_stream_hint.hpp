@@ -0,0 +1,69 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/stream_hint.hpp>
+#include <teiacare/video_io/video_info.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+namespace tc::vio::tests
+{
+class stream_hint_test : public testing::Test
+{
+protected:
+    explicit stream_hint_test()
+        : cache{std::make_shared<vio::stream_hint_cache>()}
+        , default_input_directory{std::filesystem::path(tc::vio::tests::utils::video_data_path)}
+        , output_directory{std::filesystem::temp_directory_path() / "teiacare_video_io_hint_tests"}
+    {
+        std::filesystem::create_directories(output_directory);
+    }
+
+    virtual ~stream_hint_test()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(output_directory, ec);
+    }
+
+    std::string video_path(const std::string& video_name) const
+    {
+        return (default_input_directory / video_name).string();
+    }
+
+    std::shared_ptr<vio::stream_hint_cache> cache;
+    const std::filesystem::path default_input_directory;
+    const std::filesystem::path output_directory;
+};
+
+void expect_same_hint(const vio::stream_hint& a, const vio::stream_hint& b)
+{
+    EXPECT_EQ(a.format_name, b.format_name);
+    EXPECT_EQ(a.stream_index, b.stream_index);
+    EXPECT_EQ(a.codec_name, b.codec_name);
+    EXPECT_EQ(a.pixel_format_name, b.pixel_format_name);
+    EXPECT_EQ(a.width, b.width);
+    EXPECT_EQ(a.height, b.height);
+    EXPECT_EQ(a.frame_rate_num, b.frame_rate_num);
+    EXPECT_EQ(a.frame_rate_den, b.frame_rate_den);
+    EXPECT_NEAR(a.duration, b.duration, 0.001);
+}
+
+}
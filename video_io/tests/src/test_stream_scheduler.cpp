@@ -0,0 +1,145 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_stream_scheduler.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace tc::vio::tests
+{
+
+TEST_F(stream_scheduler_test, add_stream_without_start)
+{
+    vio::frame f;
+    ASSERT_FALSE(s->is_running());
+    ASSERT_EQ(s->add_stream(default_video_path.string().c_str()), -1);
+    ASSERT_FALSE(s->read(0, f));
+    ASSERT_TRUE(s->is_end_of_stream(0));
+}
+
+TEST_F(stream_scheduler_test, more_streams_than_workers)
+{
+    ASSERT_TRUE(s->start({.worker_count = 2}));
+    ASSERT_EQ(s->get_worker_count(), 2u);
+
+    // Blocking streams wait for their frames to be read, so none is dropped
+    std::vector<int> stream_ids;
+    for (int i = 0; i < 6; ++i)
+    {
+        const int stream_id = s->add_stream(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.priority = 1 + i % 2, .queue_capacity = 2, .overflow = vio::overflow_policy::block});
+        ASSERT_GE(stream_id, 0);
+        stream_ids.push_back(stream_id);
+    }
+    ASSERT_EQ(s->get_stream_count(), 6u);
+
+    vio::frame f;
+    for (int i = 0; i < total_frames; ++i)
+    {
+        for (int stream_id : stream_ids)
+        {
+            ASSERT_TRUE(s->read(stream_id, f));
+            ASSERT_NEAR(f.pts(), i / fps, 0.5 / fps);
+        }
+    }
+
+    for (int stream_id : stream_ids)
+    {
+        ASSERT_FALSE(s->read(stream_id, f));
+        ASSERT_TRUE(s->is_end_of_stream(stream_id));
+        ASSERT_EQ(s->get_dropped_frame_count(stream_id), 0u);
+    }
+}
+
+TEST_F(stream_scheduler_test, frame_callback)
+{
+    ASSERT_TRUE(s->start({.worker_count = 2}));
+
+    std::atomic<int> frame_count{0};
+    std::atomic<int> wrong_stream_count{0};
+    int expected_stream_id = -1;
+    auto on_frame = [&](int stream_id, vio::frame& f)
+    {
+        if (stream_id != expected_stream_id || !f.is_valid())
+            ++wrong_stream_count;
+        ++frame_count;
+    };
+
+    expected_stream_id = 0;
+    ASSERT_EQ(s->add_stream(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.on_frame = on_frame}), expected_stream_id);
+    ASSERT_TRUE(wait_until([&] { return s->is_end_of_stream(expected_stream_id); }));
+    ASSERT_EQ(frame_count, total_frames);
+    ASSERT_EQ(wrong_stream_count, 0);
+}
+
+TEST_F(stream_scheduler_test, overflow_drop_oldest)
+{
+    ASSERT_TRUE(s->start({.worker_count = 1}));
+
+    const int stream_id = s->add_stream(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.queue_capacity = 2});
+    ASSERT_GE(stream_id, 0);
+    ASSERT_TRUE(wait_until([&] { return s->get_dropped_frame_count(stream_id) == total_frames - 2; }));
+
+    // Only the two most recent frames are left
+    vio::frame f;
+    ASSERT_TRUE(s->read(stream_id, f));
+    ASSERT_NEAR(f.pts(), (total_frames - 2) / fps, 0.5 / fps);
+    ASSERT_TRUE(s->read(stream_id, f));
+    ASSERT_NEAR(f.pts(), (total_frames - 1) / fps, 0.5 / fps);
+    ASSERT_FALSE(s->read(stream_id, f));
+}
+
+TEST_F(stream_scheduler_test, remove_stream_while_decoding)
+{
+    ASSERT_TRUE(s->start({.worker_count = 2}));
+
+    std::atomic<int> frame_count{0};
+    const int stream_id = s->add_stream(default_video_path.string().c_str(), vio::decode_support::SW, {}, {.on_frame = [&](int, vio::frame&) { ++frame_count; }});
+    ASSERT_GE(stream_id, 0);
+    ASSERT_TRUE(wait_until([&] { return frame_count > 0; }));
+
+    // No callback runs once the stream is removed
+    ASSERT_TRUE(s->remove_stream(stream_id));
+    const int removed_frame_count = frame_count;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(frame_count, removed_frame_count);
+
+    vio::frame f;
+    ASSERT_FALSE(s->remove_stream(stream_id));
+    ASSERT_FALSE(s->read(stream_id, f));
+    ASSERT_EQ(s->get_stream_count(), 0u);
+}
+
+TEST_F(stream_scheduler_test, remove_stalled_live_stream)
+{
+    ASSERT_TRUE(s->start({.worker_count = 1}));
+
+    // After the only session, nobody pushes to the listening reader: its worker is held by the reconnection until the stream is removed
+    const std::string url = "rtsp://127.0.0.1:8555/scheduler_stalled";
+    std::thread camera(utils::push_live_sessions, default_video_path, url, 1);
+
+    std::atomic<int> frame_count{0};
+    const int stream_id = s->add_stream(url.c_str(), vio::decode_support::SW, {}, {.on_frame = [&](int, vio::frame&) { ++frame_count; }}, {.rtsp_listen = true, .open_timeout = std::chrono::seconds(2), .reconnect_attempts = -1});
+    camera.join();
+    ASSERT_GE(stream_id, 0);
+    ASSERT_TRUE(wait_until([&] { return frame_count > 0; }));
+
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(s->remove_stream(stream_id));
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    ASSERT_EQ(s->get_stream_count(), 0u);
+}
+
+}
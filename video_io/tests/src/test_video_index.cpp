@@ -0,0 +1,183 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "test_video_index.hpp"
+
+namespace tc::vio::tests
+{
+
+TEST_F(video_index_test, build_save_load)
+{
+    const auto video_path = copy_video("video_10sec_4fps_HD.mp4");
+
+    vio::video_index index;
+    ASSERT_TRUE(index.build(video_path.string().c_str()));
+    ASSERT_EQ(index.get_frame_count().value(), 40);
+    ASSERT_TRUE(index.get_entries().front().keyframe);
+    ASSERT_TRUE(index.is_up_to_date(video_path.string().c_str()));
+
+    ASSERT_TRUE(index.save(video_path.string().c_str()));
+    ASSERT_TRUE(std::filesystem::exists(vio::video_index::get_sidecar_path(video_path.string().c_str())));
+
+    vio::video_index loaded;
+    ASSERT_TRUE(loaded.load(video_path.string().c_str()));
+    ASSERT_TRUE(loaded.is_up_to_date(video_path.string().c_str()));
+    ASSERT_EQ(loaded.get_stream_index(), index.get_stream_index());
+    ASSERT_EQ(loaded.get_time_base(), index.get_time_base());
+    expect_same_entries(loaded.get_entries(), index.get_entries());
+
+    // Frame timestamps are in presentation order
+    for (int i = 1; i < 40; ++i)
+        ASSERT_LT(loaded.get_frame_timestamp(i - 1).value(), loaded.get_frame_timestamp(i).value());
+    ASSERT_FALSE(loaded.get_frame_timestamp(40).has_value());
+
+    const auto keyframe = loaded.find_keyframe(loaded.get_frame_timestamp(39).value());
+    ASSERT_TRUE(keyframe.has_value());
+    ASSERT_TRUE(keyframe->keyframe);
+    ASSERT_LE(keyframe->pts, loaded.get_frame_timestamp(39).value());
+}
+
+TEST_F(video_index_test, save_load_unknown_timestamps)
+{
+    const auto video_path = copy_video("video_10sec_4fps_HD.mp4");
+    const auto sidecar_path = vio::video_index::get_sidecar_path(video_path.string().c_str());
+
+    // AV_NOPTS_VALUE, next to regular timestamps: the deltas between them do not fit in an int64_t
+    constexpr int64_t no_pts = std::numeric_limits<int64_t>::min();
+    const std::vector<vio::index_entry> entries = {
+        {0, no_pts, 48, 1000, true},
+        {no_pts, no_pts, 1048, 200, false},
+        {std::numeric_limits<int64_t>::max(), 512, -1, 300, false},
+        {no_pts, 1024, 1548, 10, true},
+        {2048, std::numeric_limits<int64_t>::max(), 1558, 20, false},
+    };
+
+    // Sidecar written by hand: header, then every field as a zigzag varint delta from the previous entry, with wrap around
+    {
+        auto write_varint = [](std::ostream& os, uint64_t value) {
+            for (; value >= 0x80; value >>= 7)
+                os.put(static_cast<char>((value & 0x7F) | 0x80));
+            os.put(static_cast<char>(value));
+        };
+        auto write_delta = [&](std::ostream& os, int64_t value, int64_t previous) {
+            const auto delta = static_cast<int64_t>(static_cast<uint64_t>(value) - static_cast<uint64_t>(previous));
+            write_varint(os, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+        };
+
+        std::ofstream file(sidecar_path, std::ios::binary | std::ios::trunc);
+        file << "VIOIDX01";
+        for (uint64_t header_field : {0, 1, 12800, 0, 0})
+            write_varint(file, header_field);
+        write_varint(file, entries.size());
+
+        vio::index_entry previous = {0, 0, 0, 0, false};
+        for (const auto& e : entries)
+        {
+            write_delta(file, e.pts, previous.pts);
+            write_delta(file, e.dts, previous.dts);
+            write_delta(file, e.pos, previous.pos);
+            write_varint(file, static_cast<uint64_t>(e.size));
+            file.put(e.keyframe ? 1 : 0);
+            previous = e;
+        }
+    }
+
+    vio::video_index index;
+    ASSERT_TRUE(index.load(video_path.string().c_str()));
+    expect_same_entries(index.get_entries(), entries);
+
+    // Saved and loaded again without any change
+    ASSERT_TRUE(index.save(video_path.string().c_str()));
+    vio::video_index loaded;
+    ASSERT_TRUE(loaded.load(video_path.string().c_str()));
+    expect_same_entries(loaded.get_entries(), entries);
+
+    // Packets with no timestamp at all are not frames in presentation order
+    ASSERT_EQ(loaded.get_frame_timestamp(0).value(), 0);
+    ASSERT_FALSE(loaded.get_frame_timestamp(4).has_value());
+}
+
+TEST_F(video_index_test, load_missing_sidecar)
+{
+    const auto video_path = copy_video("video_10sec_4fps_HD.mp4");
+
+    vio::video_index index;
+    ASSERT_FALSE(index.load(video_path.string().c_str()));
+    ASSERT_FALSE(index.is_up_to_date(video_path.string().c_str()));
+    ASSERT_FALSE(index.get_frame_count().has_value());
+    ASSERT_FALSE(index.save(video_path.string().c_str()));
+}
+
+TEST_F(video_index_test, incremental_build_on_grown_file)
+{
+    const std::string video_name = "video_10sec_4fps_HD.mkv";
+    const auto full_size = std::filesystem::file_size(default_input_directory / video_name);
+
+    // Index a truncated copy, as for a recording still in progress
+    const auto video_path = copy_video(video_name, full_size * 6 / 10);
+
+    vio::video_index index;
+    ASSERT_TRUE(index.build(video_path.string().c_str()));
+    const int partial_frame_count = index.get_frame_count().value();
+    ASSERT_GT(partial_frame_count, 0);
+    ASSERT_LT(partial_frame_count, 40);
+    ASSERT_TRUE(index.save(video_path.string().c_str()));
+
+    // Once the file has grown, the sidecar is out of date and video_reader ignores it
+    copy_video(video_name, full_size, true);
+    ASSERT_FALSE(index.is_up_to_date(video_path.string().c_str()));
+
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(video_path.string().c_str()));
+    ASSERT_FALSE(v.has_index());
+    v.release();
+
+    // Only the new packets are indexed, with the same result as a full build
+    vio::video_index loaded;
+    ASSERT_TRUE(loaded.load(video_path.string().c_str()));
+    ASSERT_TRUE(loaded.build(video_path.string().c_str()));
+    ASSERT_TRUE(loaded.is_up_to_date(video_path.string().c_str()));
+
+    vio::video_index full;
+    ASSERT_TRUE(full.build((default_input_directory / video_name).string().c_str()));
+    expect_same_entries(loaded.get_entries(), full.get_entries());
+}
+
+TEST_F(video_index_test, video_reader_uses_sidecar)
+{
+    const double fps = 4.0;
+    const auto video_path = copy_video("video_10sec_4fps_HD.mp4");
+
+    vio::video_index index;
+    ASSERT_TRUE(index.build(video_path.string().c_str()));
+    ASSERT_TRUE(index.save(video_path.string().c_str()));
+
+    vio::video_reader v;
+    ASSERT_TRUE(v.open(video_path.string().c_str()));
+    ASSERT_TRUE(v.has_index());
+    ASSERT_EQ(v.get_frame_count().value(), 40);
+
+    vio::frame f;
+    double landing_pts = -1.0;
+    ASSERT_TRUE(v.seek_frame(17, vio::seek_mode::exact, &landing_pts));
+    ASSERT_NEAR(landing_pts, 17 / fps, 0.5 / fps);
+    ASSERT_TRUE(v.read(f));
+    ASSERT_EQ(f.pts(), landing_pts);
+
+    ASSERT_TRUE(v.seek(8.0, vio::seek_mode::fast, &landing_pts));
+    ASSERT_LE(landing_pts, 8.0);
+    ASSERT_FALSE(v.seek_frame(40));
+}
+
+}
@@ -0,0 +1,81 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/video_index.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+
+#include "utils/video_data_path.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+namespace tc::vio::tests
+{
+class video_index_test : public testing::Test
+{
+protected:
+    explicit video_index_test()
+        : default_input_directory{std::filesystem::path(tc::vio::tests::utils::video_data_path)}
+        , output_directory{std::filesystem::temp_directory_path() / "teiacare_video_io_index_tests"}
+    {
+        std::filesystem::create_directories(output_directory);
+    }
+
+    virtual ~video_index_test()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(output_directory, ec);
+    }
+
+    // Copy the first bytes of a test video, so that sidecar files are not written next to the test data
+    std::filesystem::path copy_video(const std::string& video_name, size_t max_bytes = SIZE_MAX, bool append = false) const
+    {
+        const auto src_path = default_input_directory / video_name;
+        const auto dst_path = output_directory / video_name;
+
+        std::ifstream src(src_path, std::ios::binary);
+        std::vector<char> data((std::istreambuf_iterator<char>(src)), std::istreambuf_iterator<char>());
+
+        const size_t begin = append ? static_cast<size_t>(std::filesystem::file_size(dst_path)) : 0;
+        const size_t end = std::min(max_bytes, data.size());
+
+        std::ofstream dst(dst_path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        dst.write(data.data() + begin, static_cast<std::streamsize>(end - begin));
+        return dst_path;
+    }
+
+    const std::filesystem::path default_input_directory;
+    const std::filesystem::path output_directory;
+};
+
+void expect_same_entries(const std::vector<vio::index_entry>& a, const std::vector<vio::index_entry>& b)
+{
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_EQ(a[i].pts, b[i].pts);
+        EXPECT_EQ(a[i].dts, b[i].dts);
+        EXPECT_EQ(a[i].pos, b[i].pos);
+        EXPECT_EQ(a[i].size, b[i].size);
+        EXPECT_EQ(a[i].keyframe, b[i].keyframe);
+    }
+}
+
+}
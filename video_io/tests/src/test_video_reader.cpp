@@ -14,7 +14,15 @@
 
 #include "test_video_reader.hpp"
 
+#include <teiacare/video_io/video_index.hpp>
+#include <teiacare/video_io/video_writer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <thread>
+#include <utility>
 
 namespace tc::vio::tests
 {
@@ -148,6 +156,981 @@ TEST_F(video_reader_test, open_different_paths_read_all_files_in_parallel)
     }
 }
 
+TEST_F(video_reader_test, read_with_decode_threads)
+{
+    const auto video_path = default_input_directory / "video_10sec_4fps_FHD.mp4";
+    constexpr const int total_frames = 40;
+    constexpr const double pts_increment = 0.25;
+
+    for (auto threading : {decode_threading::automatic, decode_threading::frame, decode_threading::slice})
+    {
+        const auto decode_opt = decode_options{.thread_count = 4, .threading = threading};
+        ASSERT_TRUE(v->open(video_path.string().c_str(), decode_support::SW, decode_opt));
+        ASSERT_GE(v->get_decode_thread_count().value_or(0), 1);
+
+        uint8_t* data_buffer = nullptr;
+        double pts = 0.0;
+        for (int current_frame_index = 0; current_frame_index != total_frames; ++current_frame_index)
+        {
+            ASSERT_TRUE(v->read(&data_buffer, &pts));
+            ASSERT_NEAR(pts, current_frame_index * pts_increment, pts_increment * 0.5);
+        }
+
+        ASSERT_FALSE(v->read(&data_buffer, &pts));
+        v->release();
+    }
+}
+
+TEST_F(video_reader_test, read_frames_are_not_overwritten)
+{
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+
+    constexpr const int num_frames = 8;
+    std::vector<vio::frame> frames;
+    std::vector<std::vector<uint8_t>> frames_content;
+    for (int current_frame_index = 0; current_frame_index != num_frames; ++current_frame_index)
+    {
+        vio::frame f;
+        ASSERT_TRUE(v->read(f));
+        ASSERT_TRUE(f.is_valid());
+        ASSERT_EQ(f.size_in_bytes(), static_cast<size_t>(v->get_frame_size_in_bytes().value()));
+
+        std::vector<uint8_t> content(f.size_in_bytes());
+        ASSERT_TRUE(f.copy_to(content.data(), content.size()));
+        frames_content.push_back(std::move(content));
+        frames.push_back(std::move(f));
+    }
+
+    // Keep reading with both APIs: the frames held so far must not be modified
+    uint8_t* data_buffer = nullptr;
+    ASSERT_TRUE(v->read(&data_buffer));
+    vio::frame next_frame;
+    ASSERT_TRUE(v->read(next_frame));
+
+    for (int current_frame_index = 0; current_frame_index != num_frames; ++current_frame_index)
+    {
+        std::vector<uint8_t> content(frames[current_frame_index].size_in_bytes());
+        ASSERT_TRUE(frames[current_frame_index].copy_to(content.data(), content.size()));
+        ASSERT_EQ(content, frames_content[current_frame_index]);
+    }
+}
+
+TEST_F(video_reader_test, frame_share_copy_move)
+{
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+
+    vio::frame f;
+    ASSERT_FALSE(f.is_valid());
+    ASSERT_EQ(f.data(), nullptr);
+    ASSERT_TRUE(v->read(f));
+
+    vio::frame shared = f.share();
+    ASSERT_TRUE(shared.is_valid());
+    ASSERT_EQ(shared.data(), f.data());
+    ASSERT_EQ(shared.pts(), f.pts());
+
+    vio::frame copied = f.copy();
+    ASSERT_TRUE(copied.is_valid());
+    ASSERT_NE(copied.data(), f.data());
+    ASSERT_EQ(copied.width(), f.width());
+    ASSERT_EQ(copied.height(), f.height());
+    ASSERT_EQ(copied.pts(), f.pts());
+
+    vio::frame moved = std::move(f);
+    ASSERT_TRUE(moved.is_valid());
+    ASSERT_EQ(moved.data(), shared.data());
+
+    // A moved-from frame can be read into again
+    ASSERT_TRUE(v->read(f));
+    ASSERT_TRUE(f.is_valid());
+    ASSERT_GT(f.pts(), moved.pts());
+
+    moved.release();
+    ASSERT_FALSE(moved.is_valid());
+    ASSERT_TRUE(shared.is_valid());
+}
+
+TEST_F(video_reader_test, read_into_caller_buffer)
+{
+    auto reference_reader = std::make_unique<vio::video_reader>();
+    ASSERT_TRUE(reference_reader->open(default_video_path.string().c_str()));
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+
+    const auto [width, height] = v->get_frame_size().value();
+    const int stride = width * 3 + static_cast<int>(vio::video_reader::buffer_alignment); // padded rows
+    const size_t size = static_cast<size_t>(stride) * height;
+    alignas(vio::video_reader::buffer_alignment) static uint8_t buffer[1280 * 720 * 4];
+    ASSERT_LE(size, sizeof(buffer));
+
+    for (int current_frame_index = 0; current_frame_index != 4; ++current_frame_index)
+    {
+        double pts = -1.0;
+        ASSERT_TRUE(v->read_into(buffer, stride, size, &pts));
+
+        uint8_t* reference_data = nullptr;
+        double reference_pts = -1.0;
+        ASSERT_TRUE(reference_reader->read(&reference_data, &reference_pts));
+        ASSERT_EQ(pts, reference_pts);
+
+        for (int row = 0; row < height; ++row)
+        {
+            ASSERT_EQ(std::memcmp(buffer + row * stride, reference_data + row * width * 3, width * 3), 0);
+        }
+    }
+}
+
+TEST_F(video_reader_test, read_into_invalid_buffer)
+{
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+
+    const auto [width, height] = v->get_frame_size().value();
+    const int stride = width * 3;
+    const size_t size = static_cast<size_t>(stride) * height;
+    alignas(vio::video_reader::buffer_alignment) static uint8_t buffer[1280 * 720 * 3 + vio::video_reader::buffer_alignment];
+    ASSERT_LE(size, sizeof(buffer));
+
+    ASSERT_FALSE(v->read_into(nullptr, stride, size));
+    ASSERT_FALSE(v->read_into(buffer, stride, size - 1));
+    ASSERT_FALSE(v->read_into(buffer, stride - static_cast<int>(vio::video_reader::buffer_alignment), size));
+    ASSERT_FALSE(v->read_into(buffer + 1, stride, size));
+    ASSERT_FALSE(v->read_into(buffer, stride + 1, size + height));
+
+    // Rejected buffers must not consume any frame
+    double pts = -1.0;
+    ASSERT_TRUE(v->read_into(buffer, stride, size, &pts));
+    ASSERT_EQ(pts, 0.0);
+}
+
+TEST_F(video_reader_test, read_native_planes)
+{
+    ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::native}));
+
+    const auto [width, height] = v->get_frame_size().value();
+    ASSERT_EQ(v->get_frame_size_in_bytes().value(), width * height * 3 / 2);
+
+    vio::frame f;
+    ASSERT_TRUE(v->read(f));
+    ASSERT_STREQ(f.format_name(), "yuv420p");
+    ASSERT_EQ(f.planes(), 3);
+    ASSERT_EQ(f.width(), width);
+    ASSERT_EQ(f.height(), height);
+    ASSERT_GE(f.linesize(0), width);
+    ASSERT_GE(f.linesize(1), width / 2);
+    ASSERT_GE(f.linesize(2), width / 2);
+    ASSERT_NE(f.data(0), nullptr);
+    ASSERT_NE(f.data(1), nullptr);
+    ASSERT_NE(f.data(2), nullptr);
+    ASSERT_EQ(f.data(3), nullptr);
+
+    // read_into() copies the planes into the caller buffer, using half stride for the chroma planes
+    auto reference_reader = std::make_unique<vio::video_reader>();
+    ASSERT_TRUE(reference_reader->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::native}));
+
+    const int stride = width;
+    const size_t size = static_cast<size_t>(v->get_frame_size_in_bytes().value());
+    alignas(vio::video_reader::buffer_alignment) static uint8_t buffer[1280 * 720 * 3 / 2];
+    ASSERT_LE(size, sizeof(buffer));
+    ASSERT_TRUE(reference_reader->read_into(buffer, stride, size));
+
+    for (int row = 0; row < height; ++row)
+    {
+        ASSERT_EQ(std::memcmp(buffer + row * stride, f.data(0) + row * f.linesize(0), width), 0);
+    }
+
+    const uint8_t* u_plane = buffer + stride * height;
+    for (int row = 0; row < height / 2; ++row)
+    {
+        ASSERT_EQ(std::memcmp(u_plane + row * stride / 2, f.data(1) + row * f.linesize(1), width / 2), 0);
+    }
+}
+
+TEST_F(video_reader_test, read_output_pixel_formats)
+{
+    struct expected_format
+    {
+        pixel_format format;
+        const char* name;
+        int planes;
+        int bytes_per_pixel_x2; // frame size in bytes = width * height * bytes_per_pixel_x2 / 2
+    };
+
+    const std::vector<expected_format> formats = {
+        {pixel_format::rgb24, "rgb24", 1, 6},
+        {pixel_format::bgr24, "bgr24", 1, 6},
+        {pixel_format::rgba, "rgba", 1, 8},
+        {pixel_format::bgra, "bgra", 1, 8},
+        {pixel_format::gray8, "gray", 1, 2},
+        {pixel_format::nv12, "nv12", 2, 3},
+        {pixel_format::yuv420p, "yuv420p", 3, 3}};
+
+    for (auto&& expected : formats)
+    {
+        ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = expected.format}));
+
+        const auto [width, height] = v->get_frame_size().value();
+        ASSERT_EQ(v->get_frame_size_in_bytes().value(), width * height * expected.bytes_per_pixel_x2 / 2);
+
+        vio::frame f;
+        ASSERT_TRUE(v->read(f));
+        ASSERT_EQ(f.format(), expected.format);
+        ASSERT_STREQ(f.format_name(), expected.name);
+        ASSERT_EQ(f.planes(), expected.planes);
+        ASSERT_EQ(f.size_in_bytes(), static_cast<size_t>(v->get_frame_size_in_bytes().value()));
+    }
+}
+
+TEST_F(video_reader_test, read_rgb_bgr_channel_order)
+{
+    auto rgb_reader = std::make_unique<vio::video_reader>();
+    auto bgra_reader = std::make_unique<vio::video_reader>();
+    ASSERT_TRUE(rgb_reader->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::rgb24}));
+    ASSERT_TRUE(bgra_reader->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::bgra}));
+
+    vio::frame rgb;
+    vio::frame bgra;
+    ASSERT_TRUE(rgb_reader->read(rgb));
+    ASSERT_TRUE(bgra_reader->read(bgra));
+
+    // Test videos have a solid blue background: check the top-left pixel
+    const uint8_t* rgb_pixel = rgb.data();
+    const uint8_t* bgra_pixel = bgra.data();
+    ASSERT_EQ(rgb_pixel[0], bgra_pixel[2]);
+    ASSERT_EQ(rgb_pixel[1], bgra_pixel[1]);
+    ASSERT_EQ(rgb_pixel[2], bgra_pixel[0]);
+    ASSERT_EQ(bgra_pixel[3], 255);
+    ASSERT_GT(rgb_pixel[2], rgb_pixel[0]);
+}
+
+TEST_F(video_reader_test, read_resized_output)
+{
+    const auto video_path = default_input_directory / "video_10sec_4fps_4K.mp4";
+
+    ASSERT_TRUE(v->open(video_path.string().c_str(), decode_support::SW, {}, {.width = 640, .height = 360, .resize_interpolation = interpolation::area}));
+    ASSERT_EQ(v->get_frame_size().value(), std::make_tuple(640, 360));
+    ASSERT_EQ(v->get_frame_size_in_bytes().value(), 640 * 360 * 3);
+
+    vio::frame f;
+    ASSERT_TRUE(v->read(f));
+    ASSERT_EQ(f.width(), 640);
+    ASSERT_EQ(f.height(), 360);
+    ASSERT_EQ(f.size_in_bytes(), static_cast<size_t>(640 * 360 * 3));
+
+    // Only the width is set: the aspect ratio is preserved
+    ASSERT_TRUE(v->open(video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::gray8, .width = 960}));
+    ASSERT_EQ(v->get_frame_size().value(), std::make_tuple(960, 540));
+    ASSERT_TRUE(v->read(f));
+    ASSERT_EQ(f.width(), 960);
+    ASSERT_EQ(f.height(), 540);
+
+    // Resizing to the input size with the decoder pixel format is a passthrough
+    ASSERT_TRUE(v->open(video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::yuv420p, .width = 3840, .height = 2160}));
+    ASSERT_TRUE(v->read(f));
+    ASSERT_EQ(f.width(), 3840);
+    ASSERT_EQ(f.height(), 2160);
+}
+
+TEST_F(video_reader_test, seek_time_and_frame_index)
+{
+    const double fps = 4.0;
+    const double absolute_pts_error = 0.5 / fps;
+
+    for (const auto& video_path : {default_video_path, default_input_directory / "video_10sec_4fps_HD.mkv"})
+    {
+        ASSERT_TRUE(v->open(video_path.string().c_str()));
+
+        vio::frame f;
+        double landing_pts = -1.0;
+
+        // Exact seek lands on the requested frame, which is returned by the next read
+        ASSERT_TRUE(v->seek(5.0, vio::seek_mode::exact, &landing_pts));
+        ASSERT_NEAR(landing_pts, 5.0, absolute_pts_error);
+        ASSERT_TRUE(v->read(f));
+        ASSERT_EQ(f.pts(), landing_pts);
+        ASSERT_TRUE(v->read(f));
+        ASSERT_NEAR(f.pts(), landing_pts + 1.0 / fps, absolute_pts_error);
+
+        // Seek backward
+        ASSERT_TRUE(v->seek_frame(6, vio::seek_mode::exact, &landing_pts));
+        ASSERT_NEAR(landing_pts, 6 / fps, absolute_pts_error);
+        ASSERT_TRUE(v->read(f));
+        ASSERT_EQ(f.pts(), landing_pts);
+
+        // Fast seek lands on a keyframe at or before the target
+        ASSERT_TRUE(v->seek(7.3, vio::seek_mode::fast, &landing_pts));
+        ASSERT_GE(landing_pts, 0.0);
+        ASSERT_LE(landing_pts, 7.3);
+        ASSERT_TRUE(v->read(f));
+        ASSERT_EQ(f.pts(), landing_pts);
+
+        // Seeking after the end of the stream has been reached resets the decoder
+        while (v->read(f))
+        {
+        }
+        ASSERT_TRUE(v->seek_frame(0, vio::seek_mode::exact, &landing_pts));
+        ASSERT_NEAR(landing_pts, 0.0, absolute_pts_error);
+        ASSERT_TRUE(v->read(f));
+        ASSERT_EQ(f.pts(), landing_pts);
+
+        v->release();
+    }
+
+    double landing_pts = 0.0;
+    ASSERT_FALSE(v->seek(1.0, vio::seek_mode::exact, &landing_pts));
+    ASSERT_EQ(landing_pts, -1.0);
+    ASSERT_FALSE(v->seek_frame(1));
+}
+
+TEST_F(video_reader_test, read_keyframes_only)
+{
+    const auto video_path = default_input_directory / "video_120sec_30fps_SD.mp4";
+
+    // The packet index gives the expected keyframe timestamps
+    vio::video_index index;
+    ASSERT_TRUE(index.build(video_path.string().c_str()));
+    const auto [time_base_num, time_base_den] = index.get_time_base();
+    std::vector<double> keyframe_pts;
+    for (const auto& e : index.get_entries())
+    {
+        if (e.keyframe)
+            keyframe_pts.push_back(static_cast<double>(e.pts) * time_base_num / time_base_den);
+    }
+    std::sort(keyframe_pts.begin(), keyframe_pts.end());
+    ASSERT_LT(keyframe_pts.size(), index.get_entries().size());
+
+    ASSERT_TRUE(v->open(video_path.string().c_str(), decode_support::SW, {.keyframes_only = true}));
+
+    vio::frame f;
+    std::vector<double> read_pts;
+    while (v->read(f))
+        read_pts.push_back(f.pts());
+
+    ASSERT_EQ(read_pts.size(), keyframe_pts.size());
+    for (size_t i = 0; i < read_pts.size(); ++i)
+        ASSERT_DOUBLE_EQ(read_pts[i], keyframe_pts[i]);
+}
+
+TEST_F(video_reader_test, read_temporal_subsampling)
+{
+    const auto video_path = default_input_directory / "video_10sec_30fps_HD.mp4";
+    const double fps = 30.0;
+    const double absolute_pts_error = 0.5 / fps;
+
+    auto read_all_pts = [&](const vio::decode_options& decode_opt)
+    {
+        std::vector<double> all_pts;
+        if (!v->open(video_path.string().c_str(), decode_support::SW, decode_opt))
+            return all_pts;
+
+        vio::frame f;
+        while (v->read(f))
+            all_pts.push_back(f.pts());
+        return all_pts;
+    };
+
+    const auto full_pts = read_all_pts({});
+    ASSERT_EQ(full_pts.size(), 300u);
+
+    // Every 6th frame, with the same timestamps as a full read
+    const auto step_pts = read_all_pts({.frame_step = 6});
+    ASSERT_EQ(step_pts.size(), 50u);
+    for (size_t i = 0; i < step_pts.size(); ++i)
+        ASSERT_EQ(step_pts[i], full_pts[i * 6]);
+
+    // 5 FPS out of 30 FPS, selected by timestamp
+    const auto fps_pts = read_all_pts({.target_fps = 5.0});
+    ASSERT_EQ(fps_pts.size(), 50u);
+    for (size_t i = 0; i < fps_pts.size(); ++i)
+        ASSERT_NEAR(fps_pts[i], i * 0.2, absolute_pts_error);
+
+    // A seek restarts the subsampling from the landing frame
+    double landing_pts = -1.0;
+    ASSERT_TRUE(v->open(video_path.string().c_str(), decode_support::SW, {.target_fps = 5.0}));
+    ASSERT_TRUE(v->seek(3.1, vio::seek_mode::exact, &landing_pts));
+    vio::frame f;
+    ASSERT_TRUE(v->read(f));
+    ASSERT_EQ(f.pts(), landing_pts);
+    ASSERT_TRUE(v->read(f));
+    ASSERT_NEAR(f.pts(), landing_pts + 0.2, absolute_pts_error);
+}
+
+TEST_F(video_reader_test, read_batch_nhwc_nchw)
+{
+    const auto video_path = default_input_directory / "video_10sec_4fps_SD.mp4";
+    const int batch_size = 16;
+    const size_t plane_size = 640 * 480;
+    const size_t frame_size = plane_size * 3;
+
+    std::vector<uint8_t> frames;
+    ASSERT_TRUE(v->open(video_path.string().c_str()));
+    uint8_t* data = nullptr;
+    while (v->read(&data))
+        frames.insert(frames.end(), data, data + frame_size);
+    ASSERT_EQ(frames.size(), frame_size * 40);
+
+    const size_t batch_buffer_size = frame_size * batch_size;
+    alignas(vio::video_reader::buffer_alignment) static uint8_t batch_buffer[640 * 480 * 3 * batch_size];
+    std::array<double, batch_size> batch_pts = {};
+
+    // NHWC: the batch is byte-identical to consecutive reads, with a partial batch at EOF
+    ASSERT_TRUE(v->open(video_path.string().c_str()));
+    int frame_index = 0;
+    for (int expected_count : {16, 16, 8, 0})
+    {
+        ASSERT_EQ(v->read_batch(batch_buffer, batch_buffer_size, batch_size, batch_pts.data()), expected_count);
+        for (int i = 0; i < batch_size; ++i)
+        {
+            if (i < expected_count)
+                ASSERT_NEAR(batch_pts[i], (frame_index + i) / 4.0, 0.125);
+            else
+                ASSERT_EQ(batch_pts[i], -1.0);
+        }
+
+        ASSERT_EQ(std::memcmp(batch_buffer, frames.data() + frame_size * frame_index, frame_size * expected_count), 0);
+        frame_index += expected_count;
+    }
+
+    // NCHW: one plane per channel, in RGB order
+    ASSERT_TRUE(v->open(video_path.string().c_str()));
+    ASSERT_EQ(v->read_batch(batch_buffer, batch_buffer_size, batch_size, nullptr, vio::tensor_layout::nchw), batch_size);
+    for (int i = 0; i < batch_size; ++i)
+    {
+        const uint8_t* nhwc = frames.data() + frame_size * i;
+        const uint8_t* nchw = batch_buffer + frame_size * i;
+        int max_diff = 0;
+        for (size_t p = 0; p < plane_size; ++p)
+        {
+            for (size_t c = 0; c < 3; ++c)
+                max_diff = std::max(max_diff, std::abs(nhwc[p * 3 + c] - nchw[c * plane_size + p]));
+        }
+
+        // Packed and planar RGB are produced by different swscale paths, which may round differently
+        ASSERT_LE(max_diff, 2);
+    }
+
+    // Invalid arguments
+    ASSERT_EQ(v->read_batch(batch_buffer, batch_buffer_size - 1, batch_size), 0);
+    ASSERT_EQ(v->read_batch(batch_buffer + 1, batch_buffer_size - 1, 1), 0);
+    ASSERT_EQ(v->read_batch(batch_buffer, batch_buffer_size, 0), 0);
+
+    ASSERT_TRUE(v->open(video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::nv12}));
+    ASSERT_EQ(v->read_batch(batch_buffer, batch_buffer_size, 1, nullptr, vio::tensor_layout::nchw), 0);
+}
+
+TEST_F(video_reader_test, read_pipelined)
+{
+    auto reference_reader = std::make_unique<vio::video_reader>();
+    ASSERT_TRUE(reference_reader->open(default_video_path.string().c_str()));
+    ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {.pipeline_depth = 4}));
+    ASSERT_FALSE(reference_reader->get_pipeline_stats().has_value());
+
+    // Same frames as reading on the caller's thread, through every read function
+    const size_t frame_size = static_cast<size_t>(v->get_frame_size_in_bytes().value());
+    alignas(vio::video_reader::buffer_alignment) static uint8_t buffer[1280 * 720 * 3];
+    ASSERT_LE(frame_size, sizeof(buffer));
+
+    vio::frame f;
+    vio::frame expected;
+    for (int i = 0; i < 40; ++i)
+    {
+        ASSERT_TRUE(reference_reader->read(expected));
+
+        double pts = -1.0;
+        const uint8_t* data = nullptr;
+        switch (i % 3)
+        {
+        case 0:
+            ASSERT_TRUE(v->read(f));
+            pts = f.pts();
+            data = f.data();
+            break;
+        case 1:
+            ASSERT_TRUE(v->read(const_cast<uint8_t**>(&data), &pts));
+            break;
+        case 2:
+            ASSERT_TRUE(v->read_into(buffer, 1280 * 3, sizeof(buffer), &pts));
+            data = buffer;
+            break;
+        }
+
+        ASSERT_EQ(pts, expected.pts());
+        ASSERT_EQ(std::memcmp(data, expected.data(), frame_size), 0);
+    }
+
+    ASSERT_FALSE(v->read(f));
+    ASSERT_FALSE(v->read(f));
+
+    const auto stats = v->get_pipeline_stats().value();
+    ASSERT_EQ(stats.demux.items, 40u);
+    ASSERT_EQ(stats.decode.items, 40u);
+    ASSERT_EQ(stats.convert.items, 40u);
+    ASSERT_GT(stats.decode.busy.count(), 0);
+    ASSERT_GT(stats.convert.busy.count(), 0);
+
+    // Seeking stops and restarts the pipeline, also after the end of the stream
+    double landing_pts = -1.0;
+    ASSERT_TRUE(v->seek(2.0, vio::seek_mode::exact, &landing_pts));
+    ASSERT_NEAR(landing_pts, 2.0, 0.125);
+    ASSERT_TRUE(v->read(f));
+    ASSERT_EQ(f.pts(), landing_pts);
+    ASSERT_TRUE(v->read(f));
+    ASSERT_NEAR(f.pts(), landing_pts + 0.25, 0.125);
+
+    // Release while the pipeline threads are running
+    v->release();
+    ASSERT_FALSE(v->is_opened());
+}
+
+TEST_F(video_reader_test, read_latest_frame)
+{
+    vio::frame f;
+    int frame_count = 0;
+    double last_pts = -1.0;
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+    ASSERT_FALSE(v->get_skipped_frame_count().has_value());
+    while (v->read(f))
+    {
+        ++frame_count;
+        last_pts = f.pts();
+    }
+
+    // A slow consumer only gets the newest frames: each decoded frame is either read (and converted) or skipped
+    ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {.latest_frame = true}));
+
+    int read_count = 0;
+    double pts = -1.0;
+    while (v->read(f))
+    {
+        ASSERT_GT(f.pts(), pts);
+        ASSERT_EQ(f.width(), width);
+        ASSERT_EQ(f.height(), height);
+        pts = f.pts();
+        ++read_count;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    const uint64_t skipped_count = v->get_skipped_frame_count().value();
+    ASSERT_GT(skipped_count, 0u);
+    ASSERT_EQ(read_count + skipped_count, static_cast<uint64_t>(frame_count));
+    ASSERT_EQ(v->get_pipeline_stats()->convert.items, 0u);
+
+    // The last frame is never skipped
+    ASSERT_EQ(pts, last_pts);
+}
+
+TEST_F(video_reader_test, read_simd_conversion)
+{
+    // The SIMD kernels (no resize) and swscale use the same coefficients: only the rounding may differ
+    auto reference_reader = std::make_unique<vio::video_reader>();
+    for (auto format : {pixel_format::rgb24, pixel_format::bgr24, pixel_format::rgba, pixel_format::bgra})
+    {
+        for (auto range : {vio::color_range::automatic, vio::color_range::full})
+        {
+            ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = format, .yuv_matrix = vio::color_matrix::bt709, .yuv_range = range}));
+            ASSERT_TRUE(reference_reader->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = format, .yuv_matrix = vio::color_matrix::bt709, .yuv_range = range, .simd_conversion = false}));
+
+            vio::frame f;
+            vio::frame expected;
+            for (int i = 0; i < 5; ++i)
+            {
+                ASSERT_TRUE(v->read(f));
+                ASSERT_TRUE(reference_reader->read(expected));
+                ASSERT_EQ(f.size_in_bytes(), expected.size_in_bytes());
+
+                int max_diff = 0;
+                const int row_size = static_cast<int>(f.size_in_bytes()) / f.height();
+                for (int row = 0; row < f.height(); ++row)
+                {
+                    const uint8_t* data = f.data() + row * f.linesize();
+                    const uint8_t* expected_data = expected.data() + row * expected.linesize();
+                    for (int x = 0; x < row_size; ++x)
+                        max_diff = std::max(max_diff, std::abs(data[x] - expected_data[x]));
+                }
+
+                // Both are within one step of the exact values (see read_simd_conversion_exact), each one rounding its own way
+                ASSERT_LE(max_diff, 2) << f.format_name();
+            }
+        }
+    }
+}
+
+TEST_F(video_reader_test, read_simd_conversion_exact)
+{
+    // The SIMD kernels are within one step of the exact conversion of the decoded planes, computed in double precision
+    constexpr double kr = 0.2126;
+    constexpr double kb = 0.0722;
+    constexpr double kg = 1.0 - kr - kb;
+    auto to_channel = [](double value) { return static_cast<int>(std::clamp(std::round(value), 0.0, 255.0)); };
+
+    auto planes_reader = std::make_unique<vio::video_reader>();
+    for (auto range : {vio::color_range::limited, vio::color_range::full})
+    {
+        const bool is_full_range = range == vio::color_range::full;
+        const double y_offset = is_full_range ? 0.0 : 16.0;
+        const double y_scale = is_full_range ? 1.0 : 255.0 / 219.0;
+        const double c_scale = is_full_range ? 1.0 : 255.0 / 224.0;
+
+        ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::rgb24, .yuv_matrix = vio::color_matrix::bt709, .yuv_range = range}));
+        ASSERT_TRUE(planes_reader->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::native}));
+
+        vio::frame f;
+        vio::frame planes;
+        for (int i = 0; i < 3; ++i)
+        {
+            ASSERT_TRUE(v->read(f));
+            ASSERT_TRUE(planes_reader->read(planes));
+            ASSERT_STREQ(planes.format_name(), "yuv420p");
+
+            int max_diff = 0;
+            for (int row = 0; row < f.height(); ++row)
+            {
+                const uint8_t* rgb = f.data() + row * f.linesize();
+                const uint8_t* y_row = planes.data(0) + row * planes.linesize(0);
+                const uint8_t* u_row = planes.data(1) + (row / 2) * planes.linesize(1);
+                const uint8_t* v_row = planes.data(2) + (row / 2) * planes.linesize(2);
+                for (int x = 0; x < f.width(); ++x)
+                {
+                    // Chroma samples are shared by 2x2 pixels, as in the kernels
+                    const double luma = (y_row[x] - y_offset) * y_scale;
+                    const double cb = (u_row[x / 2] - 128.0) * c_scale;
+                    const double cr = (v_row[x / 2] - 128.0) * c_scale;
+                    const int expected[3] = {
+                        to_channel(luma + 2.0 * (1.0 - kr) * cr),
+                        to_channel(luma - 2.0 * (1.0 - kb) * kb / kg * cb - 2.0 * (1.0 - kr) * kr / kg * cr),
+                        to_channel(luma + 2.0 * (1.0 - kb) * cb),
+                    };
+
+                    for (int c = 0; c < 3; ++c)
+                        max_diff = std::max(max_diff, std::abs(rgb[x * 3 + c] - expected[c]));
+                }
+            }
+
+            ASSERT_LE(max_diff, 1) << "frame " << i;
+        }
+    }
+}
+
+TEST_F(video_reader_test, read_conversion_threads)
+{
+    // Every band is converted exactly as the whole frame would be: the output does not depend on the thread count
+    auto reference_reader = std::make_unique<vio::video_reader>();
+    const vio::output_options options[] = {
+        {.format = pixel_format::rgb24},
+        {.format = pixel_format::bgra, .simd_conversion = false},
+        {.format = pixel_format::gray8},
+        {.format = pixel_format::rgb24, .width = 320, .height = 240},
+    };
+
+    for (auto output_opt : options)
+    {
+        ASSERT_TRUE(reference_reader->open(default_video_path.string().c_str(), decode_support::SW, {}, output_opt));
+        output_opt.conversion_threads = 4;
+        ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, output_opt));
+
+        vio::frame f;
+        vio::frame expected;
+        for (int i = 0; i < 5; ++i)
+        {
+            ASSERT_TRUE(v->read(f));
+            ASSERT_TRUE(reference_reader->read(expected));
+            ASSERT_EQ(f.width(), expected.width());
+            ASSERT_EQ(f.height(), expected.height());
+
+            const int row_size = static_cast<int>(f.size_in_bytes()) / f.height();
+            for (int row = 0; row < f.height(); ++row)
+                ASSERT_EQ(std::memcmp(f.data() + row * f.linesize(), expected.data() + row * expected.linesize(), row_size), 0) << f.format_name() << " row " << row;
+        }
+    }
+}
+
+TEST_F(video_reader_test, read_into_conversion_threads)
+{
+    // Threaded swscale writes straight into a caller buffer of the exact size
+    const vio::output_options output_opt = {.format = pixel_format::rgb24, .width = 320, .height = 240};
+    auto reference_reader = std::make_unique<vio::video_reader>();
+    ASSERT_TRUE(reference_reader->open(default_video_path.string().c_str(), decode_support::SW, {}, output_opt));
+    ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, {.format = pixel_format::rgb24, .width = 320, .height = 240, .conversion_threads = 4}));
+
+    constexpr int stride = 320 * 3;
+    constexpr size_t size = static_cast<size_t>(stride) * 240;
+    alignas(vio::video_reader::buffer_alignment) static uint8_t buffer[320 * 240 * 3];
+    static_assert(stride % vio::video_reader::buffer_alignment == 0);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        ASSERT_TRUE(v->read_into(buffer, stride, size));
+
+        uint8_t* reference_data = nullptr;
+        ASSERT_TRUE(reference_reader->read(&reference_data));
+        ASSERT_EQ(std::memcmp(buffer, reference_data, size), 0);
+    }
+}
+
+TEST_F(video_reader_test, read_color_options)
+{
+    auto read_first_frame = [this](const vio::output_options& output_opt) {
+        vio::frame f;
+        EXPECT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, output_opt));
+        EXPECT_TRUE(v->read(f));
+        return f;
+    };
+
+    const auto bt601 = read_first_frame({.yuv_matrix = vio::color_matrix::bt601, .yuv_range = vio::color_range::limited});
+    const auto bt709 = read_first_frame({.yuv_matrix = vio::color_matrix::bt709, .yuv_range = vio::color_range::limited});
+    const auto full_range = read_first_frame({.yuv_matrix = vio::color_matrix::bt601, .yuv_range = vio::color_range::full});
+    ASSERT_EQ(bt601.size_in_bytes(), bt709.size_in_bytes());
+    ASSERT_NE(std::memcmp(bt601.data(), bt709.data(), bt601.size_in_bytes()), 0);
+    ASSERT_NE(std::memcmp(bt601.data(), full_range.data(), bt601.size_in_bytes()), 0);
+
+    // Resized frames go through swscale, with the same colour options
+    const auto resized = read_first_frame({.width = width / 2, .yuv_matrix = vio::color_matrix::bt709, .yuv_range = vio::color_range::limited});
+    ASSERT_EQ(resized.width(), width / 2);
+}
+
+TEST_F(video_reader_test, open_low_latency_input)
+{
+    // The RTSP options are ignored by files, the reduced probing still detects the stream
+    ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {}, {}, vio::input_options::low_latency()));
+    ASSERT_EQ(v->get_frame_size(), std::make_tuple(width, height));
+
+    vio::frame f;
+    int frame_count = 0;
+    while (v->read(f))
+        ++frame_count;
+    ASSERT_EQ(frame_count, v->get_frame_count().value());
+}
+
+TEST_F(video_reader_test, read_packets)
+{
+    // The packet index gives the expected packets, in demuxing order
+    vio::video_index index;
+    ASSERT_TRUE(index.build(default_video_path.string().c_str()));
+    const auto [time_base_num, time_base_den] = index.get_time_base();
+
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+    const auto parameters = v->get_codec_parameters();
+    ASSERT_TRUE(parameters.has_value());
+    ASSERT_STREQ(parameters->codec_name(), "h264");
+    ASSERT_EQ(parameters->width(), width);
+    ASSERT_EQ(parameters->height(), height);
+    ASSERT_GT(parameters->extradata_size(), 0U);
+
+    vio::packet p;
+    size_t packet_count = 0;
+    while (v->read_packet(p))
+    {
+        ASSERT_LT(packet_count, index.get_entries().size());
+        const auto& e = index.get_entries()[packet_count++];
+        ASSERT_NE(p.data(), nullptr);
+        ASSERT_GT(p.size(), 0U);
+        ASSERT_EQ(p.is_keyframe(), e.keyframe);
+        ASSERT_DOUBLE_EQ(p.pts(), static_cast<double>(e.pts) * time_base_num / time_base_den);
+    }
+
+    ASSERT_EQ(packet_count, index.get_entries().size());
+    ASSERT_TRUE(v->is_end_of_stream());
+    ASSERT_FALSE(p.is_valid());
+}
+
+TEST_F(video_reader_test, read_packets_annexb)
+{
+    auto has_start_code = [](const uint8_t* data, size_t size) {
+        static constexpr uint8_t start_code[] = {0, 0, 1};
+        return (size >= 3 && std::memcmp(data, start_code, 3) == 0) || (size >= 4 && data[0] == 0 && std::memcmp(data + 1, start_code, 3) == 0);
+    };
+
+    // MP4 stores the SPS/PPS as an avcC record, which starts with its version (1)
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+    const auto avcc = v->get_codec_parameters();
+    ASSERT_TRUE(avcc.has_value());
+    ASSERT_FALSE(has_start_code(avcc->extradata(), avcc->extradata_size()));
+
+    ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {.annexb = true}));
+    const auto annexb = v->get_codec_parameters();
+    ASSERT_TRUE(annexb.has_value());
+    ASSERT_TRUE(has_start_code(annexb->extradata(), annexb->extradata_size()));
+
+    vio::packet p;
+    int packet_count = 0;
+    while (v->read_packet(p))
+    {
+        ASSERT_TRUE(has_start_code(p.data(), p.size())) << "packet " << packet_count;
+        ++packet_count;
+    }
+
+    ASSERT_EQ(packet_count, v->get_frame_count().value());
+}
+
+TEST_F(video_reader_test, read_packets_pipelined)
+{
+    // The demuxing thread of the pipelined mode already consumes the packets
+    ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {.pipeline_depth = 2}));
+
+    vio::packet p;
+    ASSERT_FALSE(v->read_packet(p));
+    ASSERT_FALSE(p.is_valid());
+}
+
+TEST_F(video_reader_test, read_packets_remux)
+{
+    // Stream copy from MP4 to MKV and back: the packets are the same, and all of them can still be decoded
+    const auto output_directory = std::filesystem::temp_directory_path() / "teiacare_video_io_remux_tests";
+    std::filesystem::create_directories(output_directory);
+
+    for (const auto& [input_extension, output_extension] : {std::pair{".mp4", ".mkv"}, std::pair{".mkv", ".mp4"}})
+    {
+        const auto input_path = (default_input_directory / default_video_name).replace_extension(input_extension);
+        const auto output_path = (output_directory / default_video_name).replace_extension(output_extension);
+
+        ASSERT_TRUE(v->open(input_path.string().c_str()));
+        const auto parameters = v->get_codec_parameters();
+        ASSERT_TRUE(parameters.has_value());
+
+        vio::video_writer writer;
+        ASSERT_TRUE(writer.open(output_path.string(), *parameters));
+        ASSERT_FALSE(writer.write(frame_data.data()));
+
+        vio::packet p;
+        std::vector<std::pair<size_t, bool>> input_packets;
+        while (v->read_packet(p))
+        {
+            input_packets.emplace_back(p.size(), p.is_keyframe());
+            ASSERT_TRUE(writer.write_packet(p));
+        }
+        ASSERT_TRUE(writer.save());
+
+        ASSERT_TRUE(v->open(output_path.string().c_str()));
+        std::vector<std::pair<size_t, bool>> output_packets;
+        while (v->read_packet(p))
+            output_packets.emplace_back(p.size(), p.is_keyframe());
+        ASSERT_EQ(output_packets, input_packets);
+
+        ASSERT_TRUE(v->open(output_path.string().c_str()));
+        vio::frame f;
+        size_t frame_count = 0;
+        while (v->read(f))
+            ++frame_count;
+        ASSERT_EQ(frame_count, input_packets.size());
+    }
+
+    std::filesystem::remove_all(output_directory);
+}
+
+TEST_F(video_reader_test, open_timeout)
+{
+    // Nobody pushes to the RTSP server started by the reader: open() gives up at the deadline instead of waiting forever
+    vio::input_options input_opt;
+    input_opt.rtsp_listen = true;
+    input_opt.open_timeout = std::chrono::milliseconds(200);
+
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_FALSE(v->open("rtsp://127.0.0.1:8555/timeout", decode_support::SW, {}, {}, input_opt));
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    ASSERT_FALSE(v->is_opened());
+}
+
+TEST_F(video_reader_test, read_with_deadlines)
+{
+    // Files are never reconnected, and deadlines longer than any read do not change what is read
+    vio::input_options input_opt;
+    input_opt.open_timeout = std::chrono::seconds(5);
+    input_opt.read_timeout = std::chrono::seconds(5);
+    input_opt.idle_timeout = std::chrono::seconds(5);
+    input_opt.reconnect_attempts = 3;
+
+    for (int pipeline_depth : {0, 4})
+    {
+        ASSERT_TRUE(v->open(default_video_path.string().c_str(), decode_support::SW, {.pipeline_depth = pipeline_depth}, {}, input_opt));
+
+        vio::frame f;
+        int frame_count = 0;
+        while (v->read(f))
+            ++frame_count;
+
+        ASSERT_EQ(frame_count, v->get_frame_count().value());
+        ASSERT_EQ(v->get_reconnect_count(), 0);
+    }
+}
+
+TEST_F(video_reader_test, reconnect_live_input)
+{
+    // The reader, as the RTSP server, takes the second connection without probing it again and keeps decoding with the same decoder
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+    const int frames_per_session = v->get_frame_count().value();
+
+    const std::string url = "rtsp://127.0.0.1:8555/reconnect";
+    std::thread camera(utils::push_live_sessions, default_video_path, url, 2);
+
+    vio::input_options input_opt;
+    input_opt.rtsp_listen = true;
+    input_opt.open_timeout = std::chrono::seconds(2);
+    input_opt.reconnect_attempts = 1;
+
+    const bool is_opened = v->open(url.c_str(), decode_support::SW, {}, {}, input_opt);
+
+    // After the second session, the only reconnection attempt times out and the stream ends
+    vio::frame f;
+    int frame_count = 0;
+    while (is_opened && v->read(f))
+        ++frame_count;
+
+    camera.join();
+    ASSERT_TRUE(is_opened);
+    ASSERT_GT(frame_count, frames_per_session);
+    ASSERT_TRUE(v->is_end_of_stream());
+
+    // The previous connection is kept until release(): the stream properties are still available
+    ASSERT_TRUE(v->is_opened());
+    ASSERT_EQ(v->get_reconnect_count(), 1);
+    ASSERT_FALSE(v->read(f));
+}
+
+TEST_F(video_reader_test, reconnect_live_input_remux)
+{
+    // A recording of a live input that reconnects keeps every packet of both sessions, with increasing timestamps
+    const auto output_path = std::filesystem::temp_directory_path() / "teiacare_video_io_reconnect_remux.mkv";
+    const std::string url = "rtsp://127.0.0.1:8555/reconnect_remux";
+    std::thread camera(utils::push_live_sessions, default_video_path, url, 2);
+
+    vio::input_options input_opt;
+    input_opt.rtsp_listen = true;
+    input_opt.open_timeout = std::chrono::seconds(2);
+    input_opt.reconnect_attempts = 1;
+
+    const bool is_opened = v->open(url.c_str(), decode_support::SW, {}, {}, input_opt);
+    const auto parameters = is_opened ? v->get_codec_parameters() : std::nullopt;
+
+    vio::video_writer writer;
+    const bool is_writer_opened = parameters && writer.open(output_path.string(), *parameters);
+
+    vio::packet p;
+    size_t discontinuity_count = 0;
+    while (is_writer_opened && v->read_packet(p) && writer.write_packet(p))
+        discontinuity_count += p.is_discontinuity() ? 1 : 0;
+
+    camera.join();
+    ASSERT_TRUE(is_writer_opened);
+    ASSERT_TRUE(writer.save());
+    ASSERT_EQ(discontinuity_count, 1u);
+
+    ASSERT_TRUE(v->open(default_video_path.string().c_str()));
+    const int frames_per_session = v->get_frame_count().value();
+
+    // No packet of the second session is dropped as a non increasing one
+    ASSERT_TRUE(v->open(output_path.string().c_str()));
+    vio::frame f;
+    int frame_count = 0;
+    double pts = -1.0;
+    while (v->read(f))
+    {
+        ASSERT_GT(f.pts(), pts);
+        pts = f.pts();
+        ++frame_count;
+    }
+    ASSERT_GT(frame_count, frames_per_session + frames_per_session / 2);
+
+    std::filesystem::remove(output_path);
+}
+
 INSTANTIATE_TEST_SUITE_P(video_reader_MP4,
                          parametrized_video_reader_test,
                          ::testing::Values(
@@ -16,6 +16,7 @@
 
 #include <teiacare/video_io/video_reader.hpp>
 
+#include "utils/live_source.hpp"
 #include "utils/video_data_path.hpp"
 #include "utils/video_params.hpp"
 #include <array>
@@ -0,0 +1,58 @@
+// Copyright 2024 TeiaCare
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <teiacare/video_io/packet.hpp>
+#include <teiacare/video_io/video_reader.hpp>
+#include <teiacare/video_io/video_writer.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace tc::vio::tests::utils
+{
+// Stand-in camera: pushes the video over RTSP to a listening reader, once per session, dropping the connection in between
+inline void push_live_sessions(const std::filesystem::path& video_path, const std::string& url, int session_count)
+{
+    for (int session = 0; session < session_count; ++session)
+    {
+        vio::video_reader source;
+        if (!source.open(video_path.string().c_str()))
+            return;
+
+        const auto parameters = source.get_codec_parameters();
+        if (!parameters)
+            return;
+
+        // The reader only accepts connections once it is listening
+        vio::video_writer writer;
+        for (int attempt = 0; attempt < 500 && !writer.open(url, *parameters); ++attempt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        if (!writer.is_opened())
+            return;
+
+        vio::packet p;
+        while (source.read_packet(p) && writer.write_packet(p))
+        {
+        }
+
+        writer.save();
+    }
+}
+
+}